@@ -0,0 +1,110 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#if defined(__SLIBC_MAJOR__)
+# include <slibc-alloc.h>
+#endif
+
+
+
+/**
+ * Benchmark of the memory footprint of many small
+ * objects. The objects are allocated and touched,
+ * and the growth of the resident set is divided by
+ * the number of objects.
+ * 
+ * Usage: footprint [malloc|falloc [count [size]]]
+ * 
+ * By default, 4000000 objects of 16 bytes are allocated
+ * with `malloc`. `falloc` is only available with slibc.
+ * Run the benchmark once per allocator, as memory that
+ * has been deallocated may remain resident.
+ */
+
+
+
+/**
+ * Get the size of the resident set.
+ * 
+ * @return  The size of the resident set, in bytes.
+ */
+static size_t resident(void)
+{
+  unsigned long int pages = 0;
+  FILE* f = fopen("/proc/self/statm", "r");
+  if (f == NULL)
+    return 0;
+  if (fscanf(f, "%*s %lu", &pages) != 1)
+    pages = 0;
+  fclose(f);
+  return (size_t)pages * (size_t)sysconf(_SC_PAGESIZE);
+}
+
+
+int main(int argc, char* argv[])
+{
+  const char* allocator = argc > 1 ? argv[1] : "malloc";
+  size_t count = argc > 2 ? (size_t)atol(argv[2]) : 4000000;
+  size_t size = argc > 3 ? (size_t)atol(argv[3]) : 16;
+  void** objects = malloc(count * sizeof(void*));
+  size_t before, after, i;
+  int use_falloc = !strcmp(allocator, "falloc");
+  
+  if ((objects == NULL) || (size == 0))
+    return 1;
+#if !defined(__SLIBC_MAJOR__)
+  if (use_falloc)
+    return fprintf(stderr, "%s: falloc requires slibc\n", argv[0]), 1;
+#endif
+  /* Make the array resident before the objects are measured. */
+  memset(objects, 0, count * sizeof(void*));
+  
+  before = resident();
+  for (i = 0; i < count; i++)
+    {
+#if defined(__SLIBC_MAJOR__)
+      if (use_falloc)
+	objects[i] = falloc(NULL, NULL, 0, 0, size, 0);
+      else
+#endif
+	objects[i] = malloc(size);
+      if (objects[i] == NULL)
+	return perror(argv[0]), 1;
+      memset(objects[i], 1, size);
+    }
+  after = resident();
+  
+  printf("%s: %zu objects of %zu bytes, %zu bytes resident, %.2f bytes per object\n",
+	 allocator, count, size, after - before, (double)(after - before) / (double)count);
+  
+  for (i = 0; i < count; i++)
+    {
+#if defined(__SLIBC_MAJOR__)
+      if (use_falloc)
+	falloc(objects[i], NULL, 0, size, 0, 0);
+      else
+#endif
+	free(objects[i]);
+    }
+  free(objects);
+  return 0;
+}
+
@@ -0,0 +1,170 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+
+/**
+ * Benchmark of deallocations from other threads than the
+ * allocating thread. Each producer allocates blocks, with
+ * sizes from 16 to 512 bytes, and passes them through a
+ * ring to its consumer, which deallocates them.
+ * 
+ * Usage: producer-consumer [pairs [blocks-per-producer]]
+ * 
+ * The number of blocks passed per second, in total
+ * over all producer/consumer pairs, is printed.
+ */
+
+
+
+/**
+ * The number of slots in a ring, a power of two.
+ */
+#define RING_SIZE  1024
+
+
+
+/**
+ * A single-producer, single-consumer ring of blocks.
+ */
+struct ring
+{
+  /**
+   * The number of blocks the producer has pushed.
+   */
+  size_t head;
+  
+  /**
+   * The number of blocks the consumer has popped,
+   * in a separate cache line from `head`.
+   */
+  size_t tail __attribute__((__aligned__(64)));
+  
+  /**
+   * The blocks.
+   */
+  void* slots[RING_SIZE] __attribute__((__aligned__(64)));
+};
+
+
+
+/**
+ * The number of blocks per producer.
+ */
+static size_t blocks = (size_t)1 << 22;
+
+
+
+/**
+ * Allocate blocks, and push them to the ring.
+ * 
+ * @param   ring_  The ring.
+ * @return         `NULL`.
+ */
+static void* producer(void* ring_)
+{
+  struct ring* ring = ring_;
+  size_t x = (size_t)ring | 1;
+  size_t i;
+  char* block;
+  
+  for (i = 0; i < blocks; i++)
+    {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      block = malloc(16 + x % 497);
+      if (block == NULL)
+	abort();
+      *block = 0;
+      while (i - __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) == RING_SIZE)
+	sched_yield();
+      ring->slots[i % RING_SIZE] = block;
+      __atomic_store_n(&ring->head, i + 1, __ATOMIC_RELEASE);
+    }
+  
+  return NULL;
+}
+
+
+/**
+ * Pop blocks from the ring, and deallocate them.
+ * 
+ * @param   ring_  The ring.
+ * @return         `NULL`.
+ */
+static void* consumer(void* ring_)
+{
+  struct ring* ring = ring_;
+  size_t i;
+  
+  for (i = 0; i < blocks; i++)
+    {
+      while (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) == i)
+	sched_yield();
+      free(ring->slots[i % RING_SIZE]);
+      __atomic_store_n(&ring->tail, i + 1, __ATOMIC_RELEASE);
+    }
+  
+  return NULL;
+}
+
+
+int main(int argc, char* argv[])
+{
+  long pairs = argc > 1 ? atol(argv[1]) : 1;
+  pthread_t* threads;
+  struct ring* rings;
+  struct timespec start, end;
+  double seconds;
+  long i;
+  
+  if (argc > 2)
+    blocks = (size_t)atol(argv[2]);
+  if (pairs < 1)
+    pairs = 1;
+  
+  threads = malloc((size_t)pairs * 2 * sizeof(pthread_t));
+  if ((threads == NULL) || posix_memalign((void**)&rings, 64, (size_t)pairs * sizeof(struct ring)))
+    return perror(argv[0]), 1;
+  memset(rings, 0, (size_t)pairs * sizeof(struct ring));
+  
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 0; i < pairs; i++)
+    if (pthread_create(threads + 2 * i, NULL, producer, rings + i) ||
+	pthread_create(threads + 2 * i + 1, NULL, consumer, rings + i))
+      abort();
+  for (i = 0; i < pairs * 2; i++)
+    pthread_join(threads[i], NULL);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  
+  seconds = (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+  printf("%li pairs, %zu blocks per producer, %.2f Mblocks/s\n",
+	 pairs, blocks, (double)blocks * (double)pairs / seconds / 1e6);
+  
+  free(rings);
+  free(threads);
+  return 0;
+}
+
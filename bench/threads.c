@@ -0,0 +1,135 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+
+
+
+/**
+ * Benchmark of how `malloc` and `free` scale with the
+ * number of threads. Each thread replaces blocks in
+ * a small working set of its own, with sizes from 16
+ * to 512 bytes, so no block is shared between threads.
+ * 
+ * Usage: threads [max-threads [operations-per-thread]]
+ * 
+ * For each number of threads, from 1 to `max-threads`
+ * (the number of online CPUs by default), the total
+ * throughput, and the speedup over one thread, is printed.
+ */
+
+
+
+/**
+ * The number of live blocks per thread.
+ */
+#define WORKING_SET  64
+
+
+
+/**
+ * The number of `malloc`/`free` pairs per thread.
+ */
+static size_t operations = (size_t)1 << 22;
+
+
+
+/**
+ * Replace blocks in the thread's working set.
+ * 
+ * @param   seed  The seed of the thread's size sequence.
+ * @return        `NULL`.
+ */
+static void* worker(void* seed)
+{
+  void* blocks[WORKING_SET] = { NULL };
+  size_t x = (size_t)seed | 1;
+  size_t i;
+  
+  for (i = 0; i < operations; i++)
+    {
+      x ^= x << 13;
+      x ^= x >> 7;
+      x ^= x << 17;
+      free(blocks[i % WORKING_SET]);
+      blocks[i % WORKING_SET] = malloc(16 + x % 497);
+      if (blocks[i % WORKING_SET] == NULL)
+	abort();
+      *(char*)(blocks[i % WORKING_SET]) = 0;
+    }
+  
+  for (i = 0; i < WORKING_SET; i++)
+    free(blocks[i]);
+  return NULL;
+}
+
+
+/**
+ * Run the workers.
+ * 
+ * @param   n  The number of threads.
+ * @return     The wall-clock time, in seconds.
+ */
+static double run(size_t n)
+{
+  pthread_t* threads = malloc(n * sizeof(pthread_t));
+  struct timespec start, end;
+  size_t i;
+  
+  if (threads == NULL)
+    abort();
+  
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (i = 0; i < n; i++)
+    if (pthread_create(threads + i, NULL, worker, (void*)(i * 0x9E3779B9UL)))
+      abort();
+  for (i = 0; i < n; i++)
+    pthread_join(threads[i], NULL);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  
+  free(threads);
+  return (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+
+int main(int argc, char* argv[])
+{
+  long max = argc > 1 ? atol(argv[1]) : sysconf(_SC_NPROCESSORS_ONLN);
+  double rate, single = 0;
+  long n;
+  
+  if (argc > 2)
+    operations = (size_t)atol(argv[2]);
+  if (max < 1)
+    max = 1;
+  
+  printf("threads  Mops/s  speedup\n");
+  for (n = 1; n <= max; n++)
+    {
+      rate = (double)operations * (double)n / run((size_t)n) / 1e6;
+      if (n == 1)
+	single = rate;
+      printf("%7li  %6.1f  %7.2f\n", n, rate, rate / single);
+    }
+  
+  return 0;
+}
+
@@ -33,6 +33,7 @@
 #define EISDIR 1
 #define EACCES 1
 #define ENOTSUP 1
+#define EAGAIN 1
 
 
 
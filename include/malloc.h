@@ -186,6 +186,50 @@ void* realloc(void*, size_t)
 void free(void*)
   __slibc_warning("Use 'fast_free' or 'secure_free' instead.");
 
+#if defined(__C23__) || defined(__BUILDING_SLIBC)
+/**
+ * Variant of `free` for allocations whose size is known.
+ * The memory is released to the heap without looking up
+ * which size class it belongs to.
+ * 
+ * As a slibc extension, `errno` is guaranteed not to be set.
+ * 
+ * @etymology  (Free) allocated memory of known (size).
+ * 
+ * @param  ptr   Pointer to the beginning of the memory allocation,
+ *               which must have been returned by `malloc`, `calloc`,
+ *               or `realloc`. If it is `NULL`, nothing will happen.
+ * @param  size  The size of the allocation, that is, the size
+ *               that was passed to the function that returned `ptr`,
+ *               or the product of the arguments for `calloc`.
+ * 
+ * @since  Always.
+ */
+void free_sized(void*, size_t);
+
+/**
+ * Variant of `free` for allocations whose size
+ * and alignment are known. The memory is released
+ * to the heap without looking up which size class
+ * it belongs to.
+ * 
+ * As a slibc extension, `errno` is guaranteed not to be set,
+ * and `ptr` may also have been returned by `memalign`,
+ * `posix_memalign`, or `valloc`.
+ * 
+ * @etymology  (Free) (aligned) allocated memory of known (size).
+ * 
+ * @param  ptr        Pointer to the beginning of the memory allocation,
+ *                    which must have been returned by `aligned_alloc`.
+ *                    If it is `NULL`, nothing will happen.
+ * @param  alignment  The alignment that was passed to `aligned_alloc`.
+ * @param  size       The size that was passed to `aligned_alloc`.
+ * 
+ * @since  Always.
+ */
+void free_aligned_sized(void*, size_t, size_t);
+#endif
+
 /**
  * This function is identical to `free`.
  * Any argument beyond the first argument, is ignored.
@@ -213,8 +257,10 @@ void cfree(void*, ...)
  * specified alignment.
  * 
  * It is unspecified how the function works. This implemention
- * will allocate a bit of extra memory and shift the returned
- * pointer so that it is aligned.
+ * will use a size class whose blocks are naturally aligned if
+ * there is one that is small enough, and otherwise allocate a
+ * bit of extra memory and shift the returned pointer so that
+ * it is aligned.
  * 
  * As a GNU-compliant slibc extension, memory allocated
  * with this function can be freed with `free`.
@@ -325,8 +371,10 @@ void* pvalloc(size_t)
  * specified alignment.
  * 
  * It is unspecified how the function works. This implemention
- * will allocate a bit of extra memory and shift the returned
- * pointer so that it is aligned.
+ * will use a size class whose blocks are naturally aligned if
+ * there is one that is small enough, and otherwise allocate a
+ * bit of extra memory and shift the returned pointer so that
+ * it is aligned.
  * 
  * @etymology  (Aligned) memory (alloc)ation.
  * 
@@ -368,8 +416,343 @@ size_t malloc_usable_size(void*)
   __warning("This function is dangerous, avoid using it instead of manual bookkeeping.");
 #endif
 
-/* TODO add mallopt, M_TRIME_THRESHOLD, M_TOP_PAD, M_MMAP_THRESHOLD, and M_MMAP_MAX */
-/* TODO add struct mallinfo, and mallinfo */
+#if defined(__SVID_SOURCE) || defined(__GNU_SOURCE)
+/**
+ * `mallopt` parameter: allocations larger than this
+ * many bytes get a memory mapping of their own. Values
+ * above 16 kibibytes, which is the default value, are
+ * treated as 16 kibibytes.
+ * 
+ * @since  Always.
+ */
+# define M_MMAP_THRESHOLD  (-3)
+
+# if defined(__SLIBC_SOURCE)
+/**
+ * `mallopt` parameter: large allocations that are at
+ * least this many bytes, including bookkeeping, are
+ * aligned to and backed by transparent huge pages.
+ * Zero disables huge pages. This is a slibc extension.
+ * 
+ * @since  Always.
+ */
+#  define M_HUGE_THRESHOLD  (-101)
+
+/**
+ * `mallopt` parameter: if non-zero, free memory is cached
+ * per CPU rather than per thread, so that the amount of
+ * cached memory is bounded by the number of CPUs rather
+ * than by the number of threads. This is useful for
+ * processes with many threads. This cannot be undone,
+ * and should be done before any threads are created.
+ * This is a slibc extension.
+ * 
+ * @since  Always.
+ */
+#  define M_CPU_CACHES  (-102)
+
+/**
+ * `mallopt` parameter: the number of bytes worth of
+ * free blocks of a size class that are moved at a time
+ * between a thread's cache and the heap. A thread
+ * caches up to twice this many bytes per size class.
+ * Size classes that are already in use are not
+ * affected. The default value is 32 kibibytes.
+ * This is a slibc extension.
+ * 
+ * @since  Always.
+ */
+#  define M_CACHE_SIZE  (-103)
+
+/**
+ * `mallopt` parameter: the number of milliseconds the
+ * memory mapping of a deallocated large allocation is
+ * kept for reuse, before the pages of the mapping are
+ * returned to the kernel. The pages are returned the
+ * next time a large allocation is created or
+ * deallocated, or `malloc_trim` is called, after
+ * that. The default value is 10000 (10 seconds).
+ * This is a slibc extension.
+ * 
+ * @since  Always.
+ */
+#  define M_PURGE_DECAY  (-104)
+
+/**
+ * `mallopt` parameter: if non-zero, the memory that small
+ * allocations are carved from is taken from the data
+ * segment, with `sbrk`, rather than from mappings of its
+ * own. This gives a contiguous heap that grows in small
+ * steps, which suits small single-threaded programs.
+ * The program must not use `brk` or `sbrk` itself.
+ * This is a slibc extension.
+ * 
+ * @since  Always.
+ */
+#  define M_BRK_HEAP  (-105)
+# endif
+
+/**
+ * Change a parameter of the memory allocator.
+ * 
+ * This is a SVID extension.
+ * 
+ * @etymology  (`malloc`)-subsystem: set (opt)ion.
+ * 
+ * @param   param  The parameter to change.
+ * @param   value  The new value of the parameter.
+ * @return         1 on success, 0 on error.
+ * 
+ * @since  Always.
+ */
+int mallopt(int, int);
+
+/* TODO add M_TRIME_THRESHOLD, M_TOP_PAD, and M_MMAP_MAX */
+
+/**
+ * Statistics about the memory allocator, see `mallinfo`.
+ * 
+ * This is a SVID extension.
+ * 
+ * @since  Always.
+ */
+struct mallinfo
+{
+  /**
+   * The number of bytes mapped for small allocations.
+   * 
+   * @since  Always.
+   */
+  int arena;
+  
+  /**
+   * The number of free blocks for small allocations.
+   * 
+   * @since  Always.
+   */
+  int ordblks;
+  
+  /**
+   * Always zero.
+   * 
+   * @since  Always.
+   */
+  int smblks;
+  
+  /**
+   * The number of large allocations, which
+   * have their own memory mappings.
+   * 
+   * @since  Always.
+   */
+  int hblks;
+  
+  /**
+   * The number of bytes mapped for large allocations.
+   * 
+   * @since  Always.
+   */
+  int hblkhd;
+  
+  /**
+   * Always zero.
+   * 
+   * @since  Always.
+   */
+  int usmblks;
+  
+  /**
+   * The number of bytes in free blocks that
+   * are cached by threads for reuse.
+   * 
+   * @since  Always.
+   */
+  int fsmblks;
+  
+  /**
+   * The number of bytes in blocks that are in use.
+   * 
+   * @since  Always.
+   */
+  int uordblks;
+  
+  /**
+   * The number of bytes mapped for small
+   * allocations that are not in use.
+   * 
+   * @since  Always.
+   */
+  int fordblks;
+  
+  /**
+   * The number of bytes mapped for small allocations
+   * that are not used by any size class, plus the
+   * number of bytes in mappings of deallocated large
+   * allocations that are kept for reuse.
+   * 
+   * @since  Always.
+   */
+  int keepcost;
+};
+
+/**
+ * Get statistics about the memory allocator.
+ * 
+ * Values that do not fit in an `int` are truncated,
+ * use `mallinfo2` instead, or `heapinfo` for more
+ * detailed statistics.
+ * 
+ * This is a SVID extension.
+ * 
+ * @etymology  (`malloc`)-subsystem: (info)rmation.
+ * 
+ * @return  The statistics.
+ * 
+ * @since  Always.
+ */
+struct mallinfo mallinfo(void)
+  __GCC_ONLY(__attribute__((__warn_unused_result__)));
+#endif
+
+#if defined(__GNU_SOURCE)
+/**
+ * Statistics about the memory allocator, see `mallinfo2`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @since  Always.
+ */
+struct mallinfo2
+{
+  /**
+   * The number of bytes mapped for small allocations.
+   * 
+   * @since  Always.
+   */
+  size_t arena;
+  
+  /**
+   * The number of free blocks for small allocations.
+   * 
+   * @since  Always.
+   */
+  size_t ordblks;
+  
+  /**
+   * Always zero.
+   * 
+   * @since  Always.
+   */
+  size_t smblks;
+  
+  /**
+   * The number of large allocations, which
+   * have their own memory mappings.
+   * 
+   * @since  Always.
+   */
+  size_t hblks;
+  
+  /**
+   * The number of bytes mapped for large allocations.
+   * 
+   * @since  Always.
+   */
+  size_t hblkhd;
+  
+  /**
+   * Always zero.
+   * 
+   * @since  Always.
+   */
+  size_t usmblks;
+  
+  /**
+   * The number of bytes in free blocks that
+   * are cached by threads for reuse.
+   * 
+   * @since  Always.
+   */
+  size_t fsmblks;
+  
+  /**
+   * The number of bytes in blocks that are in use.
+   * 
+   * @since  Always.
+   */
+  size_t uordblks;
+  
+  /**
+   * The number of bytes mapped for small
+   * allocations that are not in use.
+   * 
+   * @since  Always.
+   */
+  size_t fordblks;
+  
+  /**
+   * The number of bytes mapped for small allocations
+   * that are not used by any size class, plus the
+   * number of bytes in mappings of deallocated large
+   * allocations that are kept for reuse.
+   * 
+   * @since  Always.
+   */
+  size_t keepcost;
+};
+
+/**
+ * Get statistics about the memory allocator.
+ * 
+ * This is a GNU extension.
+ * 
+ * @etymology  (`malloc`)-subsystem: (info)rmation, version (2).
+ * 
+ * @return  The statistics.
+ * 
+ * @since  Always.
+ */
+struct mallinfo2 mallinfo2(void)
+  __GCC_ONLY(__attribute__((__warn_unused_result__)));
+
+/**
+ * Print statistics about the memory allocator,
+ * including statistics for each size class,
+ * to `stderr`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @etymology  (`malloc`)-subsystem: print (stat)istic(s).
+ * 
+ * @since  Always.
+ */
+void malloc_stats(void);
+
+/**
+ * Return unused memory to the kernel.
+ * 
+ * Mappings of deallocated large allocations are
+ * kept so that they can be reused without making
+ * system calls or taking page faults. Their pages
+ * are returned to the kernel when they have not
+ * been reused for a while, and the mappings are
+ * unmapped when too many are kept. This function
+ * unmaps them immediately, and returns the pages
+ * of the unused parts of the heap to the kernel.
+ * 
+ * This is a GNU extension.
+ * 
+ * @etymology  (`malloc`)-subsystem: (trim) the heap.
+ * 
+ * @param   pad  The number of bytes in mappings of deallocated
+ *               large allocations that may be kept.
+ * @return       1 if any memory was returned to the kernel,
+ *               0 otherwise.
+ * 
+ * @since  Always.
+ */
+int malloc_trim(size_t);
+#endif
 
 
 #endif
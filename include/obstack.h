@@ -23,7 +23,916 @@
 
 
 
-/* TODO implement obstack.h */
+#define __NEED_size_t
+#define __NEED_va_list
+#include <bits/types.h>
+
+
+
+/**
+ * A chunk of memory in an obstack. The chunks
+ * of an obstack form a linked list, the newest
+ * chunk first.
+ * 
+ * @since  Always.
+ */
+struct _obstack_chunk
+{
+  /**
+   * The end of the chunk.
+   * 
+   * @since  Always.
+   */
+  char* limit;
+  
+  /**
+   * The previous chunk, `NULL` if this
+   * is the oldest chunk.
+   * 
+   * @since  Always.
+   */
+  struct _obstack_chunk* prev;
+  
+  /**
+   * The objects in the chunk.
+   * 
+   * @since  Always.
+   */
+  char contents[4];
+};
+
+
+/**
+ * An obstack, a stack of objects, where the
+ * object on the top of the stack can grow.
+ * 
+ * This is a GNU extension.
+ * 
+ * @since  Always.
+ */
+struct obstack
+{
+  /**
+   * The preferred size of new chunks.
+   * 
+   * @since  Always.
+   */
+  size_t chunk_size;
+  
+  /**
+   * The current chunk.
+   * 
+   * @since  Always.
+   */
+  struct _obstack_chunk* chunk;
+  
+  /**
+   * The beginning of the growing object.
+   * 
+   * @since  Always.
+   */
+  char* object_base;
+  
+  /**
+   * The end of the growing object.
+   * 
+   * @since  Always.
+   */
+  char* next_free;
+  
+  /**
+   * The end of the current chunk.
+   * 
+   * @since  Always.
+   */
+  char* chunk_limit;
+  
+  /**
+   * Temporary storage for macros.
+   * 
+   * @since  Always.
+   */
+  union
+  {
+    size_t i;
+    void* p;
+  } temp;
+  
+  /**
+   * The alignment of objects, less one.
+   * 
+   * @since  Always.
+   */
+  size_t alignment_mask;
+  
+  /**
+   * The function used to allocate chunks.
+   * 
+   * @since  Always.
+   */
+  union
+  {
+    void* (*plain)(size_t);
+    void* (*extra)(void*, size_t);
+  } chunkfun;
+  
+  /**
+   * The function used to deallocate chunks.
+   * 
+   * @since  Always.
+   */
+  union
+  {
+    void (*plain)(void*);
+    void (*extra)(void*, void*);
+  } freefun;
+  
+  /**
+   * The first argument for `chunkfun` and `freefun`,
+   * if `use_extra_arg` is set.
+   * 
+   * @since  Always.
+   */
+  void* extra_arg;
+  
+  /**
+   * Whether `extra_arg` shall be passed to
+   * `chunkfun` and `freefun`.
+   * 
+   * @since  Always.
+   */
+  unsigned use_extra_arg : 1;
+  
+  /**
+   * Whether the current chunk may contain
+   * a zero-length object.
+   * 
+   * @since  Always.
+   */
+  unsigned maybe_empty_object : 1;
+  
+  /**
+   * Unused, chunk allocation failures
+   * are reported via `obstack_alloc_failed_handler`.
+   * 
+   * @since  Always.
+   */
+  unsigned alloc_failed : 1;
+};
+
+
+
+/**
+ * The function that is called if a chunk cannot be allocated.
+ * It shall not return. The default function prints an error
+ * message and exits the process with the status
+ * `obstack_exit_failure`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @since  Always.
+ */
+extern void (*obstack_alloc_failed_handler)(void);
+
+/**
+ * The exit status used by the default
+ * `obstack_alloc_failed_handler`,
+ * `EXIT_FAILURE` by default.
+ * 
+ * This is a GNU extension.
+ * 
+ * @since  Always.
+ */
+extern int obstack_exit_failure;
+
+
+#ifndef obstack_chunk_alloc
+/**
+ * The function `obstack_init` and `obstack_begin` use
+ * to allocate chunks. It can be replaced by defining
+ * `obstack_chunk_alloc` as a macro, otherwise chunks
+ * are allocated with `malloc`.
+ * 
+ * This is a slibc extension.
+ * 
+ * @param   size  The size of the chunk.
+ * @return        The chunk, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* obstack_chunk_alloc(size_t)
+  __GCC_ONLY(__attribute__((__malloc__, __warn_unused_result__)));
+#endif
+
+#ifndef obstack_chunk_free
+/**
+ * The function `obstack_init` and `obstack_begin` use
+ * to deallocate chunks. It can be replaced by defining
+ * `obstack_chunk_free` as a macro, otherwise chunks
+ * are deallocated with `free`.
+ * 
+ * This is a slibc extension.
+ * 
+ * @param  chunk  The chunk.
+ * 
+ * @since  Always.
+ */
+void obstack_chunk_free(void*);
+#endif
+
+
+/**
+ * Initialise an obstack.
+ * 
+ * Use `obstack_init`, `obstack_begin`,
+ * `obstack_specify_allocation` instead.
+ * 
+ * @param   h          The obstack.
+ * @param   size       The preferred chunk size, zero for the default.
+ * @param   alignment  The alignment of objects, zero for the default.
+ * @param   chunkfun   The function used to allocate chunks.
+ * @param   freefun    The function used to deallocate chunks.
+ * @return             1 on success, 0 if the first chunk cannot be
+ *                     allocated and `obstack_alloc_failed_handler`
+ *                     returns.
+ * 
+ * @since  Always.
+ */
+int _obstack_begin(struct obstack*, size_t, size_t, void* (*)(size_t), void (*)(void*))
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Initialise an obstack.
+ * 
+ * Use `obstack_specify_allocation_with_arg` instead.
+ * 
+ * @param   h          The obstack.
+ * @param   size       The preferred chunk size, zero for the default.
+ * @param   alignment  The alignment of objects, zero for the default.
+ * @param   chunkfun   The function used to allocate chunks.
+ * @param   freefun    The function used to deallocate chunks.
+ * @param   arg        The first argument for `chunkfun` and `freefun`.
+ * @return             1 on success, 0 if the first chunk cannot be
+ *                     allocated and `obstack_alloc_failed_handler`
+ *                     returns.
+ * 
+ * @since  Always.
+ */
+int _obstack_begin_1(struct obstack*, size_t, size_t, void* (*)(void*, size_t),
+		     void (*)(void*, void*), void*)
+  __GCC_ONLY(__attribute__((__nonnull__(1, 4, 5))));
+
+/**
+ * Move the growing object of an obstack to
+ * a new chunk, with room for at least
+ * `length` more bytes.
+ * 
+ * Use `obstack_make_room` instead.
+ * 
+ * @param  h       The obstack.
+ * @param  length  The number of bytes the object will grow by.
+ * 
+ * @since  Always.
+ */
+void _obstack_newchunk(struct obstack*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Get the amount of memory used by an obstack.
+ * 
+ * Use `obstack_memory_used` instead.
+ * 
+ * @param   h  The obstack.
+ * @return     The total size of the obstack's chunks.
+ * 
+ * @since  Always.
+ */
+size_t _obstack_memory_used(struct obstack*)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__, __pure__)));
+
+/**
+ * Check whether a pointer points into an obstack.
+ * 
+ * @param   h    The obstack.
+ * @param   obj  The pointer.
+ * @return       1 if `obj` is in one of the obstack's
+ *               chunks, 0 otherwise.
+ * 
+ * @since  Always.
+ */
+int _obstack_allocated_p(struct obstack*, void*)
+  __GCC_ONLY(__attribute__((__nonnull__(1), __warn_unused_result__, __pure__)));
+
+
+/**
+ * Initialise an obstack, chunks are allocated with
+ * `obstack_chunk_alloc` and deallocated with
+ * `obstack_chunk_free`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     1 on success, 0 if the first chunk cannot be
+ *             allocated and `obstack_alloc_failed_handler`
+ *             returns.
+ * 
+ * @since  Always.
+ */
+int (obstack_init)(struct obstack*)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#define obstack_init(h)  \
+  _obstack_begin((h), 0, 0, (void* (*)(size_t))obstack_chunk_alloc, (void (*)(void*))obstack_chunk_free)
+
+/**
+ * Variant of `obstack_init` where the
+ * preferred chunk size is specified.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h     The obstack.
+ * @param   size  The preferred chunk size, zero for the default.
+ * @return        1 on success, 0 if the first chunk cannot be
+ *                allocated and `obstack_alloc_failed_handler`
+ *                returns.
+ * 
+ * @since  Always.
+ */
+int (obstack_begin)(struct obstack*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#define obstack_begin(h, size)  \
+  _obstack_begin((h), (size), 0, (void* (*)(size_t))obstack_chunk_alloc, (void (*)(void*))obstack_chunk_free)
+
+/**
+ * Variant of `obstack_init` where the preferred
+ * chunk size, the alignment of objects, and the
+ * functions used to allocate and deallocate chunks
+ * are specified.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h          The obstack.
+ * @param   size       The preferred chunk size, zero for the default.
+ * @param   alignment  The alignment of objects, zero for the default.
+ * @param   chunkfun   The function used to allocate chunks.
+ * @param   freefun    The function used to deallocate chunks.
+ * @return             1 on success, 0 if the first chunk cannot be
+ *                     allocated and `obstack_alloc_failed_handler`
+ *                     returns.
+ * 
+ * @since  Always.
+ */
+int (obstack_specify_allocation)(struct obstack*, size_t, size_t, void* (*)(size_t), void (*)(void*))
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#define obstack_specify_allocation(h, size, alignment, chunkfun, freefun)  \
+  _obstack_begin((h), (size), (alignment), (void* (*)(size_t))(chunkfun), (void (*)(void*))(freefun))
+
+/**
+ * Variant of `obstack_specify_allocation` where
+ * `arg` is passed as the first argument to
+ * `chunkfun` and `freefun`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h          The obstack.
+ * @param   size       The preferred chunk size, zero for the default.
+ * @param   alignment  The alignment of objects, zero for the default.
+ * @param   chunkfun   The function used to allocate chunks.
+ * @param   freefun    The function used to deallocate chunks.
+ * @param   arg        The first argument for `chunkfun` and `freefun`.
+ * @return             1 on success, 0 if the first chunk cannot be
+ *                     allocated and `obstack_alloc_failed_handler`
+ *                     returns.
+ * 
+ * @since  Always.
+ */
+int (obstack_specify_allocation_with_arg)(struct obstack*, size_t, size_t, void* (*)(void*, size_t),
+					  void (*)(void*, void*), void*)
+  __GCC_ONLY(__attribute__((__nonnull__(1, 4, 5))));
+#define obstack_specify_allocation_with_arg(h, size, alignment, chunkfun, freefun, arg)  \
+  _obstack_begin_1((h), (size), (alignment), (void* (*)(void*, size_t))(chunkfun),	   \
+		   (void (*)(void*, void*))(freefun), (arg))
+
+/**
+ * Deallocate an object in an obstack, and all
+ * objects allocated after it. If `obj` is `NULL`,
+ * all objects are deallocated, and the obstack
+ * must be initialised again before it is reused.
+ * 
+ * The process is aborted if `obj` is not in the obstack.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h    The obstack.
+ * @param  obj  The object, or `NULL`.
+ * 
+ * @since  Always.
+ */
+void (obstack_free)(struct obstack*, void*)
+  __GCC_ONLY(__attribute__((__nonnull__(1))));
+#if defined(__GNUC__)
+# define obstack_free(h, obj)							\
+  ({ struct obstack* __o = (h); char* __obj = (char*)(void*)(obj);		\
+     if ((__obj > (char*)(__o->chunk)) && (__obj < __o->chunk_limit))		\
+       __o->next_free = __o->object_base = __obj;				\
+     else									\
+       (obstack_free)(__o, __obj);						\
+     (void)0; })
+#endif
+
+/**
+ * Get the total size of the chunks of an obstack.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The total size of the obstack's chunks.
+ * 
+ * @since  Always.
+ */
+size_t (obstack_memory_used)(struct obstack*)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__, __pure__)));
+#define obstack_memory_used(h)  _obstack_memory_used(h)
+
+/**
+ * Get the beginning of the growing object of an obstack.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The beginning of the growing object. It
+ *             may change when the object is grown.
+ * 
+ * @since  Always.
+ */
+void* (obstack_base)(struct obstack*)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__, __pure__)));
+#define obstack_base(h)  ((void*)((h)->object_base))
+
+/**
+ * Get the end of the growing object of an obstack.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The end of the growing object. It
+ *             may change when the object is grown.
+ * 
+ * @since  Always.
+ */
+void* (obstack_next_free)(struct obstack*)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__, __pure__)));
+#define obstack_next_free(h)  ((void*)((h)->next_free))
+
+/**
+ * The alignment of new objects in an obstack, less one.
+ * This is an lvalue, and can be changed.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h  The obstack.
+ * 
+ * @since  Always.
+ */
+#define obstack_alignment_mask(h)  ((h)->alignment_mask)
+
+/**
+ * The preferred size of new chunks in an obstack.
+ * This is an lvalue, and can be changed.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h  The obstack.
+ * 
+ * @since  Always.
+ */
+#define obstack_chunk_size(h)  ((h)->chunk_size)
+
+/**
+ * Get the size of the growing object of an obstack.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The size of the growing object.
+ * 
+ * @since  Always.
+ */
+size_t (obstack_object_size)(struct obstack*)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__, __pure__)));
+#if defined(__GNUC__)
+# define obstack_object_size(h)  \
+  ({ struct obstack* __o = (h); (size_t)(__o->next_free - __o->object_base); })
+#endif
+
+/**
+ * Get the number of bytes the growing object of
+ * an obstack can grow by without being moved to
+ * a new chunk.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The space left in the current chunk.
+ * 
+ * @since  Always.
+ */
+size_t (obstack_room)(struct obstack*)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__, __pure__)));
+#if defined(__GNUC__)
+# define obstack_room(h)  \
+  ({ struct obstack* __o = (h); (size_t)(__o->chunk_limit - __o->next_free); })
+#endif
+
+/**
+ * Check whether an obstack is empty.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     1 if no objects have been allocated,
+ *             and the growing object is empty,
+ *             0 otherwise.
+ * 
+ * @since  Always.
+ */
+int (obstack_empty_p)(struct obstack*)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__, __pure__)));
+#if defined(__GNUC__)
+# define obstack_empty_p(h)							\
+  ({ struct obstack* __o = (h);							\
+     (!(__o->chunk->prev) &&						\
+      (__o->next_free == __OBSTACK_ALIGN(__o, __o->chunk->contents))); })
+#endif
+
+/**
+ * Make sure that the growing object of an obstack
+ * can grow by a number of bytes without being moved
+ * to a new chunk. It is moved if necessary.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h       The obstack.
+ * @param  length  The number of bytes.
+ * 
+ * @since  Always.
+ */
+void (obstack_make_room)(struct obstack*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#if defined(__GNUC__)
+# define obstack_make_room(h, length)						\
+  ({ struct obstack* __o = (h); size_t __len = (length);			\
+     if ((size_t)(__o->chunk_limit - __o->next_free) < __len)			\
+       _obstack_newchunk(__o, __len);						\
+     (void)0; })
+#endif
+
+/**
+ * Grow the growing object of an obstack by
+ * a number of uninitialised bytes.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h       The obstack.
+ * @param  length  The number of bytes.
+ * 
+ * @since  Always.
+ */
+void (obstack_blank)(struct obstack*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#if defined(__GNUC__)
+# define obstack_blank(h, length)						\
+  ({ struct obstack* __o = (h); size_t __len = (length);			\
+     if ((size_t)(__o->chunk_limit - __o->next_free) < __len)			\
+       _obstack_newchunk(__o, __len);						\
+     __o->next_free += __len;							\
+     (void)0; })
+#endif
+
+/**
+ * Grow the growing object of an obstack by a copy
+ * of a memory segment.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h       The obstack.
+ * @param  data    The memory segment.
+ * @param  length  The size of the memory segment.
+ * 
+ * @since  Always.
+ */
+void (obstack_grow)(struct obstack*, const void*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#if defined(__GNUC__)
+# define obstack_grow(h, data, length)						\
+  ({ struct obstack* __o = (h); size_t __len = (length);			\
+     if ((size_t)(__o->chunk_limit - __o->next_free) < __len)			\
+       _obstack_newchunk(__o, __len);						\
+     __builtin_memcpy(__o->next_free, (data), __len);				\
+     __o->next_free += __len;							\
+     (void)0; })
+#endif
+
+/**
+ * Variant of `obstack_grow` that also
+ * appends a NUL byte.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h       The obstack.
+ * @param  data    The memory segment.
+ * @param  length  The size of the memory segment.
+ * 
+ * @since  Always.
+ */
+void (obstack_grow0)(struct obstack*, const void*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#if defined(__GNUC__)
+# define obstack_grow0(h, data, length)						\
+  ({ struct obstack* __o = (h); size_t __len = (length);			\
+     if ((size_t)(__o->chunk_limit - __o->next_free) <= __len)			\
+       _obstack_newchunk(__o, __len + 1);					\
+     __builtin_memcpy(__o->next_free, (data), __len);				\
+     __o->next_free += __len;							\
+     *(__o->next_free)++ = 0;							\
+     (void)0; })
+#endif
+
+/**
+ * Grow the growing object of an obstack by one byte.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h  The obstack.
+ * @param  c  The byte.
+ * 
+ * @since  Always.
+ */
+void (obstack_1grow)(struct obstack*, int)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#if defined(__GNUC__)
+# define obstack_1grow(h, c)							\
+  ({ struct obstack* __o = (h);							\
+     if (__o->next_free == __o->chunk_limit)					\
+       _obstack_newchunk(__o, 1);						\
+     *(__o->next_free)++ = (char)(c);						\
+     (void)0; })
+#endif
+
+/**
+ * Grow the growing object of an obstack by a pointer.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h      The obstack.
+ * @param  datum  The pointer.
+ * 
+ * @since  Always.
+ */
+void (obstack_ptr_grow)(struct obstack*, void*)
+  __GCC_ONLY(__attribute__((__nonnull__(1))));
+#if defined(__GNUC__)
+# define obstack_ptr_grow(h, datum)						\
+  ({ struct obstack* __o = (h); void* __datum = (datum);			\
+     if ((size_t)(__o->chunk_limit - __o->next_free) < sizeof(void*))		\
+       _obstack_newchunk(__o, sizeof(void*));					\
+     __builtin_memcpy(__o->next_free, &__datum, sizeof(void*));			\
+     __o->next_free += sizeof(void*);						\
+     (void)0; })
+#endif
+
+/**
+ * Grow the growing object of an obstack by an `int`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h      The obstack.
+ * @param  datum  The integer.
+ * 
+ * @since  Always.
+ */
+void (obstack_int_grow)(struct obstack*, int)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#if defined(__GNUC__)
+# define obstack_int_grow(h, datum)						\
+  ({ struct obstack* __o = (h); int __datum = (datum);				\
+     if ((size_t)(__o->chunk_limit - __o->next_free) < sizeof(int))		\
+       _obstack_newchunk(__o, sizeof(int));					\
+     __builtin_memcpy(__o->next_free, &__datum, sizeof(int));			\
+     __o->next_free += sizeof(int);						\
+     (void)0; })
+#endif
+
+/**
+ * Variant of `obstack_1grow` that does not check
+ * that there is room for the byte, see `obstack_room`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h  The obstack.
+ * @param  c  The byte.
+ * 
+ * @since  Always.
+ */
+void (obstack_1grow_fast)(struct obstack*, int)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#define obstack_1grow_fast(h, c)  ((void)(*((h)->next_free)++ = (char)(c)))
+
+/**
+ * Variant of `obstack_ptr_grow` that does not check
+ * that there is room for the pointer, see `obstack_room`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h      The obstack.
+ * @param  datum  The pointer.
+ * 
+ * @since  Always.
+ */
+void (obstack_ptr_grow_fast)(struct obstack*, void*)
+  __GCC_ONLY(__attribute__((__nonnull__(1))));
+#if defined(__GNUC__)
+# define obstack_ptr_grow_fast(h, datum)					\
+  ({ struct obstack* __o = (h); void* __datum = (datum);			\
+     __builtin_memcpy(__o->next_free, &__datum, sizeof(void*));			\
+     __o->next_free += sizeof(void*);						\
+     (void)0; })
+#endif
+
+/**
+ * Variant of `obstack_int_grow` that does not check
+ * that there is room for the integer, see `obstack_room`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h      The obstack.
+ * @param  datum  The integer.
+ * 
+ * @since  Always.
+ */
+void (obstack_int_grow_fast)(struct obstack*, int)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#if defined(__GNUC__)
+# define obstack_int_grow_fast(h, datum)					\
+  ({ struct obstack* __o = (h); int __datum = (datum);				\
+     __builtin_memcpy(__o->next_free, &__datum, sizeof(int));			\
+     __o->next_free += sizeof(int);						\
+     (void)0; })
+#endif
+
+/**
+ * Variant of `obstack_blank` that does not check
+ * that there is room for the bytes, see `obstack_room`.
+ * The growing object can be shrunk by passing the
+ * negated number of bytes.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h       The obstack.
+ * @param  length  The number of bytes.
+ * 
+ * @since  Always.
+ */
+void (obstack_blank_fast)(struct obstack*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+#define obstack_blank_fast(h, length)  ((void)((h)->next_free += (size_t)(length)))
+
+/**
+ * Finish the growing object of an obstack,
+ * and start a new, empty, growing object.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The finished object. It will not be
+ *             moved anymore.
+ * 
+ * @since  Always.
+ */
+void* (obstack_finish)(struct obstack*)
+  __GCC_ONLY(__attribute__((__nonnull__, __returns_nonnull__)));
+#if defined(__GNUC__)
+# define obstack_finish(h)							\
+  ({ struct obstack* __o = (h); void* __value = __o->object_base;		\
+     if (__o->next_free == __value)						\
+       __o->maybe_empty_object = 1;						\
+     __o->next_free = __OBSTACK_ALIGN(__o, __o->next_free);			\
+     if (__o->next_free > __o->chunk_limit)					\
+       __o->next_free = __o->chunk_limit;					\
+     __o->object_base = __o->next_free;						\
+     __value; })
+#endif
+
+/**
+ * Allocate an uninitialised object in an obstack.
+ * This is equivalent to `obstack_blank` followed
+ * by `obstack_finish`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h       The obstack.
+ * @param   length  The size of the object.
+ * @return          The object.
+ * 
+ * @since  Always.
+ */
+void* (obstack_alloc)(struct obstack*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__, __returns_nonnull__, __warn_unused_result__)));
+#if defined(__GNUC__)
+# define obstack_alloc(h, length)						\
+  ({ struct obstack* __h = (h); obstack_blank(__h, (length)); obstack_finish(__h); })
+#endif
+
+/**
+ * Copy a memory segment to a new object in
+ * an obstack. This is equivalent to `obstack_grow`
+ * followed by `obstack_finish`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h       The obstack.
+ * @param   data    The memory segment.
+ * @param   length  The size of the memory segment.
+ * @return          The object.
+ * 
+ * @since  Always.
+ */
+void* (obstack_copy)(struct obstack*, const void*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__, __returns_nonnull__, __warn_unused_result__)));
+#if defined(__GNUC__)
+# define obstack_copy(h, data, length)						\
+  ({ struct obstack* __h = (h); obstack_grow(__h, (data), (length)); obstack_finish(__h); })
+#endif
+
+/**
+ * Variant of `obstack_copy` that also
+ * appends a NUL byte.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h       The obstack.
+ * @param   data    The memory segment.
+ * @param   length  The size of the memory segment.
+ * @return          The object.
+ * 
+ * @since  Always.
+ */
+void* (obstack_copy0)(struct obstack*, const void*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__, __returns_nonnull__, __warn_unused_result__)));
+#if defined(__GNUC__)
+# define obstack_copy0(h, data, length)						\
+  ({ struct obstack* __h = (h); obstack_grow0(__h, (data), (length)); obstack_finish(__h); })
+#endif
+
+/**
+ * Grow the growing object of an obstack
+ * by a formatted string, not including
+ * the terminating NUL byte.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h       The obstack.
+ * @param   format  The formatting-string, see `printf`.
+ * @param   ...     The formatting-arguments.
+ * @return          The number of written bytes, -1 on error.
+ * 
+ * @throws  EINVAL  `format` contained unsupported formatting codes.
+ * 
+ * @since  Always.
+ */
+int obstack_printf(struct obstack*, const char*, ...)
+  __GCC_ONLY(__attribute__((__nonnull__(1, 2), __format__(__slibc_printf__, 2, 3))));
+
+/**
+ * This function is identical to `obstack_printf`,
+ * except it uses `va_list` instead of variadic arguments.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h       The obstack.
+ * @param   format  The formatting-string, see `printf`.
+ * @param   args    The formatting-arguments.
+ * @return          The number of written bytes, -1 on error.
+ * 
+ * @throws  EINVAL  `format` contained unsupported formatting codes.
+ * 
+ * @since  Always.
+ */
+int obstack_vprintf(struct obstack*, const char*, va_list)
+  __GCC_ONLY(__attribute__((__nonnull__(1, 2), __format__(__slibc_printf__, 2, 0))));
+
+
+/**
+ * Align a pointer in an obstack to
+ * the alignment of its objects.
+ * 
+ * @param   h    The obstack.
+ * @param   ptr  The pointer.
+ * @return       `ptr` rounded up to the alignment.
+ */
+#define __OBSTACK_ALIGN(h, ptr)  \
+  ((char*)(((size_t)(ptr) + (h)->alignment_mask) & ~((h)->alignment_mask)))
 
 
 
@@ -124,6 +124,239 @@ enum falloc_mode
   };
 
 
+/**
+ * Statistics about the heap, see `heapinfo`.
+ * 
+ * The number of bytes that are mapped but not in
+ * use, `mapped - in_use`, is the fragmentation of
+ * the heap, including bookkeeping and memory that
+ * is kept for future allocations.
+ * 
+ * @since  Always.
+ */
+struct heapinfo
+{
+  /**
+   * The number of bytes the heap has mapped.
+   * 
+   * @since  Always.
+   */
+  size_t mapped;
+  
+  /**
+   * The number of bytes that are in use. For small
+   * allocations, the size of their blocks is used,
+   * for large allocations, the requested size.
+   * 
+   * @since  Always.
+   */
+  size_t in_use;
+  
+  /**
+   * The number of bytes mapped for small allocations.
+   * 
+   * @since  Always.
+   */
+  size_t small_mapped;
+  
+  /**
+   * The number of bytes in blocks of small
+   * allocations that are in use.
+   * 
+   * @since  Always.
+   */
+  size_t small_in_use;
+  
+  /**
+   * The number of bytes in free blocks that
+   * are cached by threads for reuse.
+   * 
+   * @since  Always.
+   */
+  size_t small_cached;
+  
+  /**
+   * The number of bytes mapped for small allocations,
+   * that are not used by any size class, or by pools.
+   * 
+   * @since  Always.
+   */
+  size_t small_unused;
+  
+  /**
+   * The number of large allocations. Large
+   * allocations have their own memory mappings.
+   * 
+   * @since  Always.
+   */
+  size_t large_count;
+  
+  /**
+   * The number of bytes mapped for large allocations.
+   * 
+   * @since  Always.
+   */
+  size_t large_mapped;
+  
+  /**
+   * The number of bytes in large allocations,
+   * as requested by the user.
+   * 
+   * @since  Always.
+   */
+  size_t large_in_use;
+  
+  /**
+   * The number of bytes in mappings of deallocated
+   * large allocations, that are kept so that they
+   * can be reused. See `malloc_trim`.
+   * 
+   * @since  Always.
+   */
+  size_t large_retained;
+  
+  /**
+   * The number of bytes in large allocations
+   * that are backed by transparent huge pages.
+   * 
+   * @since  Always.
+   */
+  size_t huge_mapped;
+  
+  /**
+   * The number of times the heap has called `mmap`.
+   * 
+   * @since  Always.
+   */
+  size_t mmap_calls;
+  
+  /**
+   * The number of times the heap has called `munmap`.
+   * 
+   * @since  Always.
+   */
+  size_t munmap_calls;
+  
+  /**
+   * The number of times the heap has called `mremap`.
+   * 
+   * @since  Always.
+   */
+  size_t mremap_calls;
+  
+  /**
+   * The number of times the heap has returned
+   * pages to the kernel with `madvise`.
+   * 
+   * @since  Always.
+   */
+  size_t purge_calls;
+  
+  /**
+   * The number of reallocations that resized
+   * the allocation without moving it.
+   * 
+   * @since  Always.
+   */
+  size_t realloc_in_place;
+  
+  /**
+   * The number of reallocations that moved the
+   * allocation without copying it, by moving its pages.
+   * 
+   * @since  Always.
+   */
+  size_t realloc_moved;
+  
+  /**
+   * The number of reallocations that copied
+   * the allocation to a new allocation.
+   * 
+   * @since  Always.
+   */
+  size_t realloc_copied;
+  
+  /**
+   * The number of times `extalloc` resized
+   * an allocation without moving it.
+   * 
+   * @since  Always.
+   */
+  size_t extalloc_in_place;
+  
+  /**
+   * The number of times `extalloc` could not
+   * resize an allocation without moving it.
+   * 
+   * @since  Always.
+   */
+  size_t extalloc_failed;
+  
+  /**
+   * The number of size classes, see `heapinfo_classes`.
+   * 
+   * @since  Always.
+   */
+  size_t class_count;
+};
+
+
+/**
+ * Statistics about a size class of the heap,
+ * see `heapinfo_classes`. Small allocations are
+ * made from blocks of the smallest size class
+ * that can hold them.
+ * 
+ * @since  Always.
+ */
+struct heapinfo_class
+{
+  /**
+   * The size of each block in the class.
+   * 
+   * @since  Always.
+   */
+  size_t block_size;
+  
+  /**
+   * The number of blocks that are in use.
+   * 
+   * Threads only report how many blocks they have
+   * cached when they exchange blocks with the size
+   * class, so this value, `cached`, and `free` are
+   * approximate, but their sum is exact.
+   * 
+   * @since  Always.
+   */
+  size_t live;
+  
+  /**
+   * The number of free blocks that are
+   * cached by threads for reuse.
+   * 
+   * @since  Always.
+   */
+  size_t cached;
+  
+  /**
+   * The number of free blocks that are
+   * not cached by any thread.
+   * 
+   * @since  Always.
+   */
+  size_t free;
+  
+  /**
+   * The number of spans, that the blocks
+   * are carved from, used by the class.
+   * 
+   * @since  Always.
+   */
+  size_t spans;
+};
+
+
+
 /**
  * This function is identical to `free`, except it is guaranteed not to
  * override the memory segment with zeroes before freeing the allocation.
@@ -152,6 +385,88 @@ void fast_free(void*);
  */
 void secure_free(void*);
 
+/**
+ * This function is identical to `free_sized`, except it is
+ * guaranteed to override the memory segment with zeroes
+ * before freeing the allocation.
+ * 
+ * `errno` is guaranteed not to be set.
+ * 
+ * @etymology  (Secure) variant of (`free_sized`).
+ * 
+ * @param  segment  The memory segment to free.
+ * @param  size     The size of the memory segment,
+ *                  as it was requested when allocated.
+ * 
+ * @since  Always.
+ */
+void secure_free_sized(void*, size_t);
+
+/**
+ * This function is identical to `free_aligned_sized`,
+ * except it is guaranteed to override the memory segment
+ * with zeroes before freeing the allocation.
+ * 
+ * `errno` is guaranteed not to be set.
+ * 
+ * @etymology  (Secure) variant of (`free_aligned_sized`).
+ * 
+ * @param  segment    The memory segment to free.
+ * @param  alignment  The alignment of the memory segment,
+ *                    as it was requested when allocated.
+ * @param  size       The size of the memory segment,
+ *                    as it was requested when allocated.
+ * 
+ * @since  Always.
+ */
+void secure_free_aligned_sized(void*, size_t, size_t);
+
+/**
+ * Create a number of memory allocations of the same
+ * size. This is faster than calling `malloc` once
+ * for each allocation, and if many allocations are
+ * requested, the allocations are usually adjacent.
+ * 
+ * The allocations can be deallocated with `free_batch`,
+ * or individually with `free` or any of its variants.
+ * 
+ * @etymology  (M)emory (alloc)ation in a (batch).
+ * 
+ * @param   size   The size of each allocation.
+ * @param   count  The number of allocations.
+ * @param   ptrs   Output array for the allocations,
+ *                 must have room for `count` pointers.
+ * @return         The number of allocations that were created,
+ *                 they are stored at the beginning of `ptrs`.
+ *                 If less than `count` allocations could be
+ *                 created, `errno` is set to indicate the error,
+ *                 and the created allocations are not deallocated.
+ *                 If `size` is zero, all elements in `ptrs`
+ *                 are set to `NULL`, and `count` is returned.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+size_t malloc_batch(size_t, size_t, void**)
+  __GCC_ONLY(__attribute__((__warn_unused_result__)));
+
+/**
+ * Deallocate a number of memory allocations. This is
+ * faster than calling `free` once for each allocation.
+ * The memory is not overridden with zeroes.
+ * 
+ * `errno` is guaranteed not to be set.
+ * 
+ * @etymology  (Free) a (batch) of allocations.
+ * 
+ * @param  ptrs   The allocations, `NULL`s are ignored.
+ * @param  count  The number of elements in `ptrs`.
+ * 
+ * @since  Always.
+ */
+void free_batch(void**, size_t);
+
 /**
  * This function returns the allocation size of
  * a memory segment.
@@ -421,6 +736,98 @@ void* naive_extalloc(void*, size_t) /* sic! we limit ourself to ASCII */
 void* falloc(void*, size_t*, size_t, size_t, size_t, enum falloc_mode);
 
 
+/**
+ * Get statistics about the heap.
+ * 
+ * The statistics are maintained continuously, at
+ * a negligible cost, so this function is cheap,
+ * and can be called at any time, by any thread.
+ * Counters of events are never reset, the rate
+ * of events can be calculated by calling this
+ * function periodically.
+ * 
+ * @etymology  (Heap) (info)rmation.
+ * 
+ * @param  info  Output parameter for the statistics.
+ * 
+ * @since  Always.
+ */
+void heapinfo(struct heapinfo*)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Get statistics about the size classes of the heap.
+ * 
+ * @etymology  (Heap) (info)rmation: size (classes).
+ * 
+ * @param   classes  Output parameter for the statistics, ordered
+ *                   by block size. May be `NULL` if `count` is zero.
+ * @param   count    The number of elements in `classes`.
+ * @return           The number of size classes, this may be
+ *                   more than `count`, in which case only the
+ *                   `count` first classes are stored.
+ * 
+ * @since  Always.
+ */
+size_t heapinfo_classes(struct heapinfo_class*, size_t);
+
+
+/**
+ * Start, stop, or change the sampling interval of the
+ * heap profiler. When the profiler is active, it samples
+ * one allocation, on average, each time `interval` bytes
+ * have been allocated, and records its call stack.
+ * 
+ * The call stack is found by walking the frame pointers,
+ * so the program should be compiled with
+ * `-fno-omit-frame-pointer`.
+ * 
+ * The profiler can also be started by setting the
+ * environment variable `SLIBC_HEAPPROF` to the interval.
+ * The profile is then written, in the format used by
+ * `heapprof_dump`, at exit, and whenever the signal whose
+ * number is in `SLIBC_HEAPPROF_SIGNAL` is received, to the
+ * file `SLIBC_HEAPPROF_FILE`, or to standard error.
+ * 
+ * @etymology  (Heap) (prof)iler.
+ * 
+ * @param  interval  The average number of bytes between each
+ *                   sample, zero to stop sampling. Allocations
+ *                   that have already been sampled remain in
+ *                   the profile until they are deallocated.
+ * 
+ * @since  Always.
+ */
+void heapprof(size_t);
+
+/**
+ * Write the profile of the heap profiler to a file.
+ * 
+ * The profile lists the call stacks of the sampled
+ * allocations that have not been deallocated, in
+ * the folded stack format, one per line, as the
+ * return addresses, in hexadecimal, separated by
+ * semicolons, outermost first, followed by a space
+ * and the estimated number of bytes allocated at the
+ * call stack. Identical call stacks are not merged.
+ * 
+ * This function does not allocate memory, and can
+ * be called from a signal handler.
+ * 
+ * @etymology  (Heap) (prof)iler: (dump) profile.
+ * 
+ * @param   fd  The file descriptor to write to.
+ * @return      Zero on success, -1 on error.
+ * 
+ * @throws  EAGAIN  The profile is being updated by the calling
+ *                  thread, which has been interrupted.
+ * @throws          Any error specified for write(3), except `EINTR`.
+ * 
+ * @since  Always.
+ */
+int heapprof_dump(int);
+
+
 /**
  * This macro calls `fast_free` and then sets the pointer to `NULL`,
  * so that another attempt to free the segment will not crash the process.
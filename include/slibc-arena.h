@@ -0,0 +1,341 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _SLIBC_ARENA_H
+#define _SLIBC_ARENA_H
+#include <slibc/version.h>
+#include <slibc/features.h>
+#ifndef __PORTABLE
+
+
+
+#define __NEED_size_t
+#define __NEED_va_list
+#include <bits/types.h>
+
+
+
+/**
+ * The default size of the chunks an arena
+ * allocates its memory from, including the
+ * chunk's header.
+ * 
+ * @since  Always.
+ */
+#define ARENA_CHUNK_SIZE  16384
+
+
+/**
+ * A chunk of memory that an arena allocates
+ * memory from. The chunks of an arena form
+ * a linked list, the newest chunk first.
+ * 
+ * @since  Always.
+ */
+struct arena_chunk
+{
+  /**
+   * The previous chunk, `NULL` if this
+   * is the oldest chunk.
+   * 
+   * @since  Always.
+   */
+  struct arena_chunk* prev;
+  
+  /**
+   * The end of the chunk.
+   * 
+   * @since  Always.
+   */
+  char* end;
+};
+
+
+/**
+ * Region-based memory allocator. All memory
+ * allocated from an arena is released at once,
+ * either with `arena_free`, or with `arena_rewind`
+ * for all memory allocated after a savepoint.
+ * 
+ * An arena shall be initialised with `arena_init`
+ * or `ARENA_INITIALISER`.
+ * 
+ * @since  Always.
+ */
+struct arena
+{
+  /**
+   * The chunk allocations are made from,
+   * `NULL` if no memory has been allocated.
+   * 
+   * @since  Always.
+   */
+  struct arena_chunk* chunk;
+  
+  /**
+   * The first unused byte in `chunk`.
+   * 
+   * @since  Always.
+   */
+  char* next;
+  
+  /**
+   * The end of `chunk`.
+   * 
+   * @since  Always.
+   */
+  char* end;
+  
+  /**
+   * The size of new chunks, including their header.
+   * 
+   * @since  Always.
+   */
+  size_t chunk_size;
+};
+
+
+/**
+ * The state of an arena, that it can be rewound to.
+ * 
+ * @since  Always.
+ */
+struct arena_savepoint
+{
+  /**
+   * The value of `chunk` in the arena.
+   * 
+   * @since  Always.
+   */
+  struct arena_chunk* chunk;
+  
+  /**
+   * The value of `next` in the arena.
+   * 
+   * @since  Always.
+   */
+  char* next;
+};
+
+
+/**
+ * Initialiser for an empty arena with the
+ * default chunk size.
+ * 
+ * @since  Always.
+ */
+#define ARENA_INITIALISER  { NULL, NULL, NULL, ARENA_CHUNK_SIZE }
+
+
+
+/**
+ * Initialise an arena.
+ * 
+ * No memory is allocated until the first
+ * allocation is made from the arena.
+ * 
+ * @param  arena       The arena.
+ * @param  chunk_size  The size of the chunks the arena
+ *                     shall allocate from the heap,
+ *                     zero for `ARENA_CHUNK_SIZE`.
+ * 
+ * @since  Always.
+ */
+void arena_init(struct arena*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Deallocate all memory allocated from an arena.
+ * 
+ * The arena is left empty, and can be used again.
+ * 
+ * @param  arena  The arena.
+ * 
+ * @since  Always.
+ */
+void arena_free(struct arena*)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Allocate memory from an arena. The returned
+ * pointer has the same alignment as a pointer
+ * returned by `malloc`.
+ * 
+ * @param   arena  The arena.
+ * @param   size   The size of the allocation.
+ * @return         Pointer to the beginning of the new allocation.
+ *                 If `size` is zero, this function will either
+ *                 return `NULL` (that is what this implement does)
+ *                 or return a unique pointer that can later be
+ *                 freed with `arena_free`. Upon error, `NULL`
+ *                 is returned.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* arena_alloc(struct arena*, size_t)
+  __GCC_ONLY(__attribute__((__malloc__, __nonnull__, __warn_unused_result__)));
+
+/**
+ * Variant of `arena_alloc` that initialises
+ * the allocated memory with zeroes.
+ * 
+ * @param   arena  The arena.
+ * @param   size   The size of the allocation.
+ * @return         See `arena_alloc`.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* arena_zalloc(struct arena*, size_t)
+  __GCC_ONLY(__attribute__((__malloc__, __nonnull__, __warn_unused_result__)));
+
+/**
+ * Allocate memory from an arena, with a specified alignment.
+ * 
+ * @param   arena     The arena.
+ * @param   boundary  The alignment, must be a power of two.
+ * @param   size      The size of the allocation.
+ * @return            See `arena_alloc`.
+ * 
+ * @throws  EINVAL  `boundary` is not a power of two.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* arena_memalign(struct arena*, size_t, size_t)
+  __GCC_ONLY(__attribute__((__malloc__, __nonnull__, __warn_unused_result__)));
+
+/**
+ * Save the state of an arena, so that all
+ * allocations made after this call can be
+ * deallocated with `arena_rewind`.
+ * 
+ * @param  arena      The arena.
+ * @param  savepoint  Output parameter for the state.
+ * 
+ * @since  Always.
+ */
+void arena_save(const struct arena*, struct arena_savepoint*)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Deallocate all memory allocated from an arena
+ * since a savepoint was made. Savepoints made
+ * after `savepoint` become invalid.
+ * 
+ * @param  arena      The arena.
+ * @param  savepoint  The state to restore the arena to.
+ * 
+ * @since  Always.
+ */
+void arena_rewind(struct arena*, const struct arena_savepoint*)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Duplicate a memory segment into an arena.
+ * 
+ * @param   arena    The arena.
+ * @param   segment  The memory segment to duplicate.
+ * @param   size     The size of the memory segment.
+ * @return           The new segment. `NULL` is returned on error
+ *                   and `errno` is set to indicate the error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* arena_memdup(struct arena*, const void*, size_t)
+  __GCC_ONLY(__attribute__((__malloc__, __nonnull__, __warn_unused_result__)));
+
+/**
+ * Duplicate a string into an arena.
+ * 
+ * @param   arena   The arena.
+ * @param   string  The string to duplicate.
+ * @return          The new string. `NULL` is returned on error
+ *                  and `errno` is set to indicate the error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+char* arena_strdup(struct arena*, const char*)
+  __GCC_ONLY(__attribute__((__malloc__, __nonnull__, __warn_unused_result__)));
+
+/**
+ * Duplicate a string into an arena.
+ * 
+ * @param   arena   The arena.
+ * @param   string  The string to duplicate.
+ * @param   maxlen  Truncate the string to this length, if it is longer.
+ *                  A NUL byte is guaranteed to always be written
+ *                  upon successful completion.
+ * @return          The new string. `NULL` is returned on error
+ *                  and `errno` is set to indicate the error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+char* arena_strndup(struct arena*, const char*, size_t)
+  __GCC_ONLY(__attribute__((__malloc__, __nonnull__, __warn_unused_result__)));
+
+/**
+ * Format a string into an arena.
+ * 
+ * @param   arena   The arena.
+ * @param   format  The formatting-string, see `printf`.
+ * @param   ...     The formatting-arguments.
+ * @return          The new string. `NULL` is returned on error
+ *                  and `errno` is set to indicate the error.
+ * 
+ * @throws  EINVAL  `format` contained unsupported formatting codes.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+char* arena_asprintf(struct arena*, const char*, ...)
+  __GCC_ONLY(__attribute__((__malloc__, __nonnull__(1, 2), __format__(__slibc_printf__, 2, 3),
+			    __warn_unused_result__)));
+
+/**
+ * This function is identical to `arena_asprintf`,
+ * except it uses `va_list` instead of variadic arguments.
+ * 
+ * @param   arena   The arena.
+ * @param   format  The formatting-string, see `printf`.
+ * @param   args    The formatting-arguments.
+ * @return          The new string. `NULL` is returned on error
+ *                  and `errno` is set to indicate the error.
+ * 
+ * @throws  EINVAL  `format` contained unsupported formatting codes.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+char* arena_vasprintf(struct arena*, const char*, va_list)
+  __GCC_ONLY(__attribute__((__malloc__, __nonnull__(1, 2), __format__(__slibc_printf__, 2, 0),
+			    __warn_unused_result__)));
+
+
+
+#endif
+#endif
+
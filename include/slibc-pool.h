@@ -0,0 +1,251 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef _SLIBC_POOL_H
+#define _SLIBC_POOL_H
+#include <slibc/version.h>
+#include <slibc/features.h>
+#ifndef __PORTABLE
+
+
+
+#define __NEED_size_t
+#include <bits/types.h>
+
+
+
+/**
+ * The largest object size a pool supports.
+ * 
+ * @since  Always.
+ */
+#define POOL_OBJECT_MAX  65536
+
+
+/**
+ * Flags for `pool_init`. They are independent
+ * of each other, and multiple can be selected
+ * by using bitwise or between them.
+ * 
+ * @since  Always.
+ */
+enum pool_flags
+  {
+    /**
+     * The pool may be used by multiple threads
+     * at the same time.
+     * 
+     * @since  Always.
+     */
+    POOL_LOCKED = 1,
+    
+    /**
+     * Each thread keeps a small cache, a magazine,
+     * of free objects, so that the lock of the pool
+     * is only taken once per a number of allocations
+     * and deallocations. Implies `POOL_LOCKED`.
+     * 
+     * @since  Always.
+     */
+    POOL_MAGAZINES = 2,
+    
+  };
+
+
+/**
+ * Allocator for objects of a single size. Objects are
+ * carved from slabs in the same spans of pages that
+ * `malloc` uses, without any header per object, and
+ * deallocated objects are kept in a linked list that
+ * is stored in the objects themselves. All objects
+ * are released at once with `pool_destroy`.
+ * 
+ * A pool shall be initialised with `pool_init`.
+ * 
+ * @since  Always.
+ */
+struct pool
+{
+  /**
+   * Linked list of deallocated objects.
+   * 
+   * @since  Always.
+   */
+  void* free;
+  
+  /**
+   * The next object that has never been
+   * allocated, in the newest slab.
+   * 
+   * @since  Always.
+   */
+  char* next;
+  
+  /**
+   * The end of the newest slab.
+   * 
+   * @since  Always.
+   */
+  char* end;
+  
+  /**
+   * Linked list of the pool's slabs, newest first.
+   * 
+   * @since  Always.
+   */
+  void* slabs;
+  
+  /**
+   * The distance between objects.
+   * 
+   * @since  Always.
+   */
+  size_t size;
+  
+  /**
+   * The alignment of the objects.
+   * 
+   * @since  Always.
+   */
+  size_t alignment;
+  
+  /**
+   * The threads' magazines, `NULL` unless
+   * `POOL_MAGAZINES` is used.
+   * 
+   * @since  Always.
+   */
+  void* magazines;
+  
+  /**
+   * The flags the pool was initialised with.
+   * 
+   * @since  Always.
+   */
+  enum pool_flags flags;
+  
+  /**
+   * Lock for the pool, only used if
+   * `POOL_LOCKED` or `POOL_MAGAZINES` is used.
+   * 
+   * @since  Always.
+   */
+  char lock;
+};
+
+
+
+/**
+ * Initialise a pool.
+ * 
+ * No memory is allocated until the first object
+ * is allocated from the pool, unless `POOL_MAGAZINES`
+ * is used.
+ * 
+ * @param   pool       The pool.
+ * @param   size       The size of the objects.
+ * @param   alignment  The alignment of the objects, must be a
+ *                     power of two, zero for the greatest
+ *                     alignment an object of `size` bytes can
+ *                     require, but at most that of `malloc`.
+ * @param   flags      `POOL_LOCKED`, `POOL_MAGAZINES`, both, or neither.
+ * @return             Zero on success, -1 on error.
+ * 
+ * @throws  EINVAL  `size` is zero or greater than `POOL_OBJECT_MAX`,
+ *                  `alignment` is not a power of two or zero, or
+ *                  is greater than `POOL_OBJECT_MAX`, or `flags`
+ *                  is invalid.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+int pool_init(struct pool*, size_t, size_t, enum pool_flags)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__)));
+
+/**
+ * Initialise a pool for objects of a type.
+ * 
+ * @param   pool   The pool.
+ * @param   type   The type of the objects.
+ * @param   flags  `POOL_LOCKED`, `POOL_MAGAZINES`, both, or neither.
+ * @return         See `pool_init`.
+ * 
+ * @throws  EINVAL  The type is larger than `POOL_OBJECT_MAX`,
+ *                  or `flags` is invalid.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+#define pool_init_type(pool, type, flags)  \
+  (pool_init((pool), sizeof(type), __alignof__(type), (flags)))
+
+/**
+ * Deallocate all objects in a pool, and all memory the
+ * pool uses. The pool must be initialised again before
+ * it is reused. The pool must not be used by any other
+ * thread when this function is called.
+ * 
+ * @param  pool  The pool.
+ * 
+ * @since  Always.
+ */
+void pool_destroy(struct pool*)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Allocate an object from a pool.
+ * 
+ * @param   pool  The pool.
+ * @return        The object, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* pool_alloc(struct pool*)
+  __GCC_ONLY(__attribute__((__malloc__, __nonnull__, __warn_unused_result__)));
+
+/**
+ * Variant of `pool_alloc` that initialises
+ * the object with zeroes.
+ * 
+ * @param   pool  The pool.
+ * @return        The object, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* pool_zalloc(struct pool*)
+  __GCC_ONLY(__attribute__((__malloc__, __nonnull__, __warn_unused_result__)));
+
+/**
+ * Return an object to the pool it was allocated from.
+ * 
+ * @param  pool  The pool.
+ * @param  obj   The object, `NULL` is ignored.
+ * 
+ * @since  Always.
+ */
+void pool_free(struct pool*, void*)
+  __GCC_ONLY(__attribute__((__nonnull__(1))));
+
+
+
+#endif
+#endif
+
@@ -19,10 +19,22 @@
 /* These definitions are only to be used in slibc header-files. */
 
 
+/**
+ * Is C23, or newer, used?
+ */
+#if (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 202311L)) || defined(__ISOC23_SOURCE)
+# if !defined(__C23__)
+#  define __C23__
+# endif
+# if !defined(__ISOC23_SOURCE)
+#  define __ISOC23_SOURCE
+# endif
+#endif
+
 /**
  * Is C11, or newer, used?
  */
-#if (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)) || defined(__ISOC11_SOURCE)
+#if (defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201112L)) || defined(__ISOC11_SOURCE) || defined(__C23__)
 # if !defined(__C11__)
 #  define __C11__
 # endif
@@ -176,7 +176,7 @@
  * 
  * @since  Always.
  */
-int brk(void*) /* TODO implement brk */
+int brk(void*)
   __GCC_ONLY(__attribute__((__warn_unused_result__)));
 
 /**
@@ -215,7 +215,7 @@ int brk(void*) /* TODO implement brk */
  * 
  * @since  Always.
  */
-void* sbrk(ptrdiff_t) /* TODO implement sbrk */
+void* sbrk(ptrdiff_t)
   __GCC_ONLY(__attribute__((__warn_unused_result__)));
 
 
@@ -19,81 +19,17 @@
 #include <slibc/internals.h>
 #include <stddef.h>
 #include <slibc-alloc.h>
-#include <strings.h>
-/* TODO #include <sys/mman.h> */
-#include <unistd.h>
 #include <errno.h>
-/* TODO temporary constants from other headers { */
-#define PROT_READ 0
-#define PROT_WRITE 0
-#define MAP_PRIVATE 0
-#define MAP_ANONYMOUS 0
-#define _SC_PAGESIZE 0
-/* } */
+#include "malloc/heap.h"
 
 
 /**
  * Implementation of `malloc`.
  */
-#define MALLOC(size)  memalign(sizeof(max_align_t), size)
+#define MALLOC(size)  ((size) ? __slibc_heap_alloc(size) : NULL)
 
 
 
-/**
- * Return the pagesize. If it it cannot be retrieved,
- * use a fallback value.
- * 
- * @return  The pagesize, or a fallback value.
- */
-__attribute__((__warn_unused_result__, const))
-static size_t get_pagesize(void)
-{
-  static size_t pagesize = 0;
-  if (pagesize == 0)
-    {
-      /* TODO This should be done i crt0. */
-      long r = sysconf(_SC_PAGESIZE);
-      pagesize = (size_t)(r == -1 ? 4096 : r);
-    }
-  return pagesize;
-}
-
-
-/**
- * Create a new memory allocation on the heap.
- * The allocation will not be initialised.
- * The returned pointer is unaligned.
- * 
- * @param   size  The size of the allocation.
- * @return        Pointer to the beginning of the new allocation.
- *                If `size` is zero, this function will either return
- *                `NULL` (that is what this implement does) or return
- *                a unique pointer that can later be freed with `free`.
- *                `NULL` is returned on error, and `errno` is set to
- *                indicate the error.
- * 
- * @throws  ENOMEM  The process cannot allocate more memory.
- */
-static void* unaligned_malloc(size_t size)
-{
-  char* ptr;
-  size_t full_size;
-  
-  if (size == 0)
-    return NULL;
-  MEM_OVERFLOW(uaddl, 2 * sizeof(size_t), size, &full_size);
-  
-  ptr = mmap(NULL, full_size, (PROT_READ | PROT_WRITE),
-	     (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
-  if (ptr == MAP_FAILED)
-    return NULL;
-  
-  ((size_t*)ptr)[0] = size;
-  ((size_t*)ptr)[1] = 0;
-  return ptr + 2 * sizeof(size_t);
-}
-
-
 /**
  * Create a new memory allocation on the heap.
  * The allocation will not be initialised.
@@ -149,7 +85,7 @@ void* calloc(size_t elem_count, size_t elem_size)
   MEM_OVERFLOW(umull, elem_count, elem_size, &size);
   ptr = MALLOC(size);
   if (ptr != NULL)
-    explicit_bzero(ptr, size);
+    __slibc_heap_clear(ptr, 0, size);
   
   return ptr;
 }
@@ -183,7 +119,7 @@ void* mallocz(size_t size, int clear)
 {
   void* ptr = MALLOC(size);
   if ((ptr != NULL) && clear)
-    explicit_bzero(ptr, size);
+    __slibc_heap_clear(ptr, 0, size);
   return ptr;
 }
 
@@ -215,7 +151,7 @@ void* zalloc(size_t size)
 {
   void* ptr = MALLOC(size);
   if (ptr != NULL)
-    explicit_bzero(ptr, size);
+    __slibc_heap_clear(ptr, 0, size);
   return ptr;
 }
 
@@ -225,8 +161,10 @@ void* zalloc(size_t size)
  * specified alignment.
  * 
  * It is unspecified how the function works. This implemention
- * will allocate a bit of extra memory and shift the returned
- * pointer so that it is aligned.
+ * will use a size class whose blocks are naturally aligned if
+ * there is one that is small enough, and otherwise allocate a
+ * bit of extra memory and shift the returned pointer so that
+ * it is aligned.
  * 
  * As a GNU-compliant slibc extension, memory allocated
  * with this function can be freed with `free`.
@@ -249,29 +187,12 @@ void* zalloc(size_t size)
  */
 void* memalign(size_t boundary, size_t size)
 {
-  char* ptr;
-  size_t full_size;
-  size_t address;
-  size_t shift = 0;
-  
-  if (!boundary || (__builtin_ffsl((long int)boundary) != boundary))
-    /* `size_t` mat not be wider than `long int`. */
+  if (!boundary || (boundary & (boundary - 1)))
     return errno = EINVAL, NULL;
-  MEM_OVERFLOW(uaddl, boundary - 1, size, &full_size);
-  
-  ptr = unaligned_malloc(full_size);
-  if (ptr == NULL)
+  if (size == 0)
     return NULL;
   
-  address = (size_t)ptr;
-  if (address % boundary != 0)
-    {
-      shift = boundary - (address % boundary);
-      ptr += shift;
-      *(size_t*)(ptr - sizeof(size_t)) = shift;
-    }
-  
-  return ptr;
+  return __slibc_heap_alloc_aligned(boundary, size);
 }
 
 
@@ -297,7 +218,7 @@ void* memalign(size_t boundary, size_t size)
  */
 void* valloc(size_t size)
 {
-  return memalign(get_pagesize(), size);
+  return memalign(__slibc_heap_pagesize(), size);
 }
 
 
@@ -322,14 +243,10 @@ void* valloc(size_t size)
  */
 void* pvalloc(size_t size)
 {
-  size_t boundary = get_pagesize();
-  size_t full_size = 2 * sizeof(size_t) + boundary - 1 + size;
-  size_t rounding = 0;
-  
-  if (full_size % boundary != 0)
-      rounding = boundary - (full_size % boundary);
+  size_t boundary = __slibc_heap_pagesize();
+  size_t full_size;
   
-  MEM_OVERFLOW(uaddl, size, rounding, &full_size);
-  return memalign(boundary, full_size);
+  MEM_OVERFLOW(uaddl, size, boundary - 1, &full_size);
+  return memalign(boundary, full_size & ~(boundary - 1));
 }
 
@@ -27,8 +27,10 @@
  * specified alignment.
  * 
  * It is unspecified how the function works. This implemention
- * will allocate a bit of extra memory and shift the returned
- * pointer so that it is aligned.
+ * will use a size class whose blocks are naturally aligned if
+ * there is one that is small enough, and otherwise allocate a
+ * bit of extra memory and shift the returned pointer so that
+ * it is aligned.
  * 
  * @etymology  (Aligned) memory (alloc)ation.
  * 
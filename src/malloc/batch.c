@@ -0,0 +1,85 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <slibc-alloc.h>
+#include <stddef.h>
+#include <errno.h>
+#include "heap.h"
+
+
+
+/**
+ * Create a number of memory allocations of the same
+ * size. This is faster than calling `malloc` once
+ * for each allocation, and if many allocations are
+ * requested, the allocations are usually adjacent.
+ * 
+ * The allocations can be deallocated with `free_batch`,
+ * or individually with `free` or any of its variants.
+ * 
+ * @etymology  (M)emory (alloc)ation in a (batch).
+ * 
+ * @param   size   The size of each allocation.
+ * @param   count  The number of allocations.
+ * @param   ptrs   Output array for the allocations,
+ *                 must have room for `count` pointers.
+ * @return         The number of allocations that were created,
+ *                 they are stored at the beginning of `ptrs`.
+ *                 If less than `count` allocations could be
+ *                 created, `errno` is set to indicate the error,
+ *                 and the created allocations are not deallocated.
+ *                 If `size` is zero, all elements in `ptrs`
+ *                 are set to `NULL`, and `count` is returned.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+size_t malloc_batch(size_t size, size_t count, void** ptrs)
+{
+  size_t i;
+  if (size == 0)
+    {
+      for (i = 0; i < count; i++)
+	ptrs[i] = NULL;
+      return count;
+    }
+  return __slibc_heap_alloc_batch(size, count, ptrs);
+}
+
+
+/**
+ * Deallocate a number of memory allocations. This is
+ * faster than calling `free` once for each allocation.
+ * The memory is not overridden with zeroes.
+ * 
+ * `errno` is guaranteed not to be set.
+ * 
+ * @etymology  (Free) a (batch) of allocations.
+ * 
+ * @param  ptrs   The allocations, `NULL`s are ignored.
+ * @param  count  The number of elements in `ptrs`.
+ * 
+ * @since  Always.
+ */
+void free_batch(void** ptrs, size_t count)
+{
+  int saved_errno = errno;
+  __slibc_heap_free_batch(ptrs, count);
+  errno = saved_errno;
+}
+
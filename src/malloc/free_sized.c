@@ -0,0 +1,80 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <errno.h>
+#include "heap.h"
+
+
+
+/**
+ * Variant of `free` for allocations whose size is known.
+ * The memory is released to the heap without looking up
+ * which size class it belongs to.
+ * 
+ * As a slibc extension, `errno` is guaranteed not to be set.
+ * 
+ * @etymology  (Free) allocated memory of known (size).
+ * 
+ * @param  ptr   Pointer to the beginning of the memory allocation,
+ *               which must have been returned by `malloc`, `calloc`,
+ *               or `realloc`. If it is `NULL`, nothing will happen.
+ * @param  size  The size of the allocation, that is, the size
+ *               that was passed to the function that returned `ptr`,
+ *               or the product of the arguments for `calloc`.
+ * 
+ * @since  Always.
+ */
+void free_sized(void* ptr, size_t size)
+{
+  int saved_errno = errno;
+  if (ptr == NULL)
+    return;
+  __slibc_heap_free_sized(ptr, 0, size);
+  errno = saved_errno;
+}
+
+
+/**
+ * Variant of `free` for allocations whose size
+ * and alignment are known. The memory is released
+ * to the heap without looking up which size class
+ * it belongs to.
+ * 
+ * As a slibc extension, `errno` is guaranteed not to be set,
+ * and `ptr` may also have been returned by `memalign`,
+ * `posix_memalign`, or `valloc`.
+ * 
+ * @etymology  (Free) (aligned) allocated memory of known (size).
+ * 
+ * @param  ptr        Pointer to the beginning of the memory allocation,
+ *                    which must have been returned by `aligned_alloc`.
+ *                    If it is `NULL`, nothing will happen.
+ * @param  alignment  The alignment that was passed to `aligned_alloc`.
+ * @param  size       The size that was passed to `aligned_alloc`.
+ * 
+ * @since  Always.
+ */
+void free_aligned_sized(void* ptr, size_t alignment, size_t size)
+{
+  int saved_errno = errno;
+  if (ptr == NULL)
+    return;
+  __slibc_heap_free_sized(ptr, alignment, size);
+  errno = saved_errno;
+}
+
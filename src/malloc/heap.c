@@ -0,0 +1,1948 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <slibc/internals.h>
+#include <unistd.h>
+#include <errno.h>
+#include <string.h>
+#include "heap.h"
+
+
+
+/**
+ * The size classes.
+ */
+struct heap_class __slibc_heap_classes[HEAP_CLASS_COUNT];
+
+/**
+ * Large allocations whose mappings are at least this
+ * large are aligned to, and backed by, transparent
+ * huge pages. Zero if huge pages shall not be used.
+ */
+size_t __slibc_heap_huge_threshold = HEAP_HUGE_THRESHOLD;
+
+/**
+ * Allocations larger than this get a mapping of their
+ * own, rather than a block in a size class. No greater
+ * than `HEAP_SMALL_MAX`, set with
+ * `__slibc_heap_set_mmap_threshold`.
+ */
+size_t __slibc_heap_mmap_threshold = HEAP_SMALL_MAX;
+
+/**
+ * The number of bytes worth of blocks that are moved
+ * at a time between a size class and a thread's cache.
+ * Size classes that are already in use keep the number
+ * of blocks they were given when they were first used.
+ */
+size_t __slibc_heap_cache_bytes = HEAP_CACHE_BYTES;
+
+/**
+ * The number of milliseconds a mapping is kept for
+ * reuse before its pages are returned to the kernel.
+ */
+size_t __slibc_heap_retain_decay = HEAP_RETAIN_DECAY;
+
+/**
+ * Whether spans are carved from the data segment,
+ * rather than from mappings of their own.
+ */
+int __slibc_heap_brk = 0;
+
+/**
+ * The number of bytes in large allocations that
+ * are backed by transparent huge pages.
+ */
+size_t __slibc_heap_huge_bytes = 0;
+
+/**
+ * Statistics about the heap.
+ */
+struct heap_stats __slibc_heap_stats;
+
+/**
+ * Spans that are mapped but not used by any size class.
+ */
+static struct heap_span* free_spans = NULL;
+
+/**
+ * The next span that has never been used,
+ * in the most recently mapped chunk.
+ */
+static char* chunk_next = NULL;
+
+/**
+ * The number of spans, starting with `chunk_next`,
+ * that have never been used.
+ */
+static size_t chunk_left = 0;
+
+/**
+ * Lock for `free_spans`, `chunk_next`, and `chunk_left`.
+ */
+static heap_lock_t span_lock;
+
+/**
+ * Mappings of deallocated large allocations that are
+ * kept for reuse, the most recently deallocated first.
+ */
+static struct heap_span* retained = NULL;
+
+/**
+ * The last mapping in `retained`.
+ */
+static struct heap_span* retained_last = NULL;
+
+/**
+ * The number of mappings in `retained`.
+ */
+static size_t retained_count = 0;
+
+/**
+ * The number of bytes in the mappings in `retained`.
+ */
+static size_t retained_bytes = 0;
+
+/**
+ * Lock for `retained`, `retained_last`,
+ * `retained_count`, and `retained_bytes`.
+ */
+static heap_lock_t retain_lock;
+
+/**
+ * The calling thread's cache of free blocks.
+ */
+static __thread struct heap_cache heap_cache;
+
+/**
+ * The per-CPU caches of free blocks, that are used
+ * instead of the threads' caches, `NULL` unless
+ * per-CPU caches have been enabled.
+ */
+static struct heap_cache* cpu_caches = NULL;
+
+/**
+ * The number of elements in `cpu_caches`.
+ */
+static size_t cpu_count = 0;
+
+/**
+ * The lowest value `__slibc_heap_mmap_threshold`
+ * has had. Allocations of any size above this
+ * may be large allocations.
+ */
+static size_t mmap_threshold_min = HEAP_SMALL_MAX;
+
+
+
+/**
+ * Return the pagesize. If it it cannot be retrieved,
+ * use a fallback value.
+ * 
+ * @return  The pagesize, or a fallback value.
+ */
+size_t __slibc_heap_pagesize(void)
+{
+  static size_t pagesize = 0;
+  if (pagesize == 0)
+    {
+      /* TODO This should be done i crt0. */
+      long r = sysconf(_SC_PAGESIZE);
+      pagesize = (size_t)(r == -1 ? 4096 : r);
+    }
+  return pagesize;
+}
+
+
+/**
+ * Create an anonymous memory mapping with a specific alignment.
+ * 
+ * @param   size       The size of the mapping, must be a multiple of the pagesize.
+ * @param   alignment  The alignment, must be a power-of-two multiple of the pagesize.
+ * @param   skew       The mapping is aligned such that `skew` bytes into
+ *                     it is aligned, must be a multiple of the pagesize.
+ * @return             The mapping, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+static char* map_aligned(size_t size, size_t alignment, size_t skew)
+{
+  char* ptr;
+  size_t full_size;
+  size_t lead;
+  
+  /* Try our luck first, the kernel tends to place mappings
+   * next to each other, so the mapping is often aligned. */
+  HEAP_COUNT(mmap_calls, 1);
+  ptr = mmap(NULL, size, (PROT_READ | PROT_WRITE),
+	     (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+  if (ptr == MAP_FAILED)
+    return NULL;
+  if (((size_t)ptr + skew) % alignment == 0)
+    return ptr;
+  HEAP_COUNT(munmap_calls, 1);
+  munmap(ptr, size);
+  
+  MEM_OVERFLOW(uaddl, size, alignment, &full_size);
+  HEAP_COUNT(mmap_calls, 1);
+  ptr = mmap(NULL, full_size, (PROT_READ | PROT_WRITE),
+	     (MAP_PRIVATE | MAP_ANONYMOUS), -1, 0);
+  if (ptr == MAP_FAILED)
+    return NULL;
+  
+  lead = (alignment - ((size_t)ptr + skew) % alignment) % alignment;
+  if (lead)
+    HEAP_COUNT(munmap_calls, 1), munmap(ptr, lead);
+  if (alignment - lead)
+    HEAP_COUNT(munmap_calls, 1), munmap(ptr + lead + size, alignment - lead);
+  return ptr + lead;
+}
+
+
+/**
+ * Extend the data segment with memory that is
+ * aligned to the span size.
+ * 
+ * The data segment is contiguous, so no other
+ * mappings are created between the spans, and
+ * only one system call is needed per extension.
+ * 
+ * @param   size  The number of bytes, a multiple of the span size.
+ * @return        The memory, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The data segment cannot be extended.
+ */
+static char* brk_aligned(size_t size)
+{
+  char* end = sbrk(0);
+  char* ptr;
+  size_t lead;
+  
+  if (end == (void*)-1)
+    return NULL;
+  lead = -(size_t)end & (HEAP_SPAN_SIZE - 1);
+  
+  ptr = sbrk((ptrdiff_t)(lead + size));
+  if (ptr == (void*)-1)
+    return NULL;
+  /* If the data segment was moved by something else
+   * meanwhile, the memory may not be aligned. It is
+   * left unused, as it cannot be given back safely. */
+  if (ptr != end)
+    return errno = ENOMEM, NULL;
+  return ptr + lead;
+}
+
+
+/**
+ * Get the number of bytes of a large allocation that can
+ * be backed by transparent huge pages, that is, the number
+ * of bytes in whole huge pages within its mapping.
+ * 
+ * @param   span      The large allocation.
+ * @param   map_size  The size of the allocation's mapping.
+ * @return            The number of bytes, zero if the allocation
+ *                    has not been advised to use huge pages.
+ */
+static size_t huge_bytes(struct heap_span* span, size_t map_size)
+{
+  size_t start = ((size_t)span + HEAP_HUGE_PAGE_SIZE - 1) & ~(HEAP_HUGE_PAGE_SIZE - 1);
+  size_t end = ((size_t)span + map_size) & ~(HEAP_HUGE_PAGE_SIZE - 1);
+  return (span->huge && (end > start)) ? (end - start) : 0;
+}
+
+
+/**
+ * Record that the user may have written to all of a large
+ * allocation, when its mapping has been resized, but before
+ * its size is updated. Pages that are removed from the
+ * mapping are zero if they are mapped again.
+ * 
+ * @param  span      The large allocation.
+ * @param  map_size  The new size of the allocation's mapping.
+ */
+static void large_written(struct heap_span* span, size_t map_size)
+{
+  size_t end = (size_t)(span->data - (char*)span) + span->size;
+  if (span->zero < end)
+    span->zero = end;
+  if (span->zero > map_size)
+    span->zero = map_size;
+}
+
+
+/**
+ * Calculate the layout of the spans of a size class.
+ * 
+ * @param  class  The size class.
+ * @param  index  The index of the size class.
+ */
+static void class_init(struct heap_class* class, size_t index)
+{
+  size_t size = heap_class_size(index);
+  size_t alignment = size & -size;
+  size_t count, offset;
+  
+  if (alignment > HEAP_CLASS_ALIGN_MAX)
+    alignment = HEAP_CLASS_ALIGN_MAX;
+  
+  count = (HEAP_SPAN_SIZE - sizeof(struct heap_span)) / (size + sizeof(uint16_t));
+  for (;; count--)
+    {
+      offset = sizeof(struct heap_span) + count * sizeof(uint16_t);
+      offset = (offset + alignment - 1) & ~(alignment - 1);
+      if (offset + count * size <= HEAP_SPAN_SIZE)
+	break;
+    }
+  
+  class->alignment  = alignment;
+  class->count      = count;
+  class->offset     = offset;
+  class->reciprocal = (((uint64_t)1 << 32) + size - 1) / size;
+  class->batch      = __slibc_heap_cache_bytes / size;
+  class->size       = size;
+  
+  if (class->batch < HEAP_CACHE_BATCH_MIN)
+    class->batch = HEAP_CACHE_BATCH_MIN;
+  if (class->batch > HEAP_CACHE_BATCH_MAX)
+    class->batch = HEAP_CACHE_BATCH_MAX;
+}
+
+
+/**
+ * Get an unused span.
+ * 
+ * @return  An unused span, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+static struct heap_span* span_get(void)
+{
+  struct heap_span* span;
+  char* chunk;
+  size_t n;
+  
+  HEAP_LOCK(span_lock);
+  if (free_spans != NULL)
+    {
+      span = free_spans;
+      free_spans = span->next;
+      goto done;
+    }
+  if (chunk_left == 0)
+    {
+      /* The data segment is extended by one span
+       * at a time, so that the program's memory
+       * footprint grows as little as possible. */
+      n = 1;
+      chunk = __slibc_heap_brk ? brk_aligned(HEAP_SPAN_SIZE) : NULL;
+      if (chunk == NULL)
+	{
+	  n = HEAP_CHUNK_SPANS;
+	  chunk = map_aligned(n * HEAP_SPAN_SIZE, HEAP_SPAN_SIZE, 0);
+	}
+      if (chunk == NULL)
+	{
+	  HEAP_UNLOCK(span_lock);
+	  return NULL;
+	}
+      chunk_next = chunk;
+      chunk_left = n;
+      HEAP_COUNT(small_mapped, n * HEAP_SPAN_SIZE);
+    }
+  span = (struct heap_span*)(void*)chunk_next;
+  chunk_next += HEAP_SPAN_SIZE;
+  chunk_left -= 1;
+ done:
+  HEAP_UNLOCK(span_lock);
+  return span;
+}
+
+
+/**
+ * Return an span, that is no longer used, to the heap.
+ * 
+ * @param  span  The span.
+ */
+static void span_put(struct heap_span* span)
+{
+  HEAP_LOCK(span_lock);
+  span->next = free_spans;
+  free_spans = span;
+  HEAP_UNLOCK(span_lock);
+}
+
+
+/**
+ * Get an unused span, for memory that is not
+ * managed by the size classes.
+ * 
+ * @return  An unused span, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+void* __slibc_heap_span_get(void)
+{
+  void* span = span_get();
+  if (span != NULL)
+    HEAP_COUNT(small_lent, HEAP_SPAN_SIZE);
+  return span;
+}
+
+
+/**
+ * Return a span from `__slibc_heap_span_get`
+ * to the heap.
+ * 
+ * @param  span  The span.
+ */
+void __slibc_heap_span_put(void* span)
+{
+  HEAP_COUNT(small_lent, -HEAP_SPAN_SIZE);
+  span_put(span);
+}
+
+
+/**
+ * Take a block from the spans of a size class.
+ * The class must be locked.
+ * 
+ * @param   class  The size class.
+ * @param   index  The index of the size class.
+ * @return         The block, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+static char* class_pop(struct heap_class* class, size_t index)
+{
+  struct heap_span* span;
+  char* block;
+  
+  span = class->partial;
+  if (span == NULL)
+    {
+      span = span_get();
+      if (span == NULL)
+	return NULL;
+      span->class      = index + 1;
+      span->block_size = class->size;
+      span->data       = (char*)span + class->offset;
+      span->count      = class->count;
+      span->carved     = 0;
+      span->used       = 0;
+      span->free       = NULL;
+      span->next       = NULL;
+      span->prev       = NULL;
+      span->sizes      = (uint16_t*)(void*)(span + 1);
+      span->size       = 0;
+      class->partial   = span;
+      class->spans    += 1;
+    }
+  
+  if (span->free != NULL)
+    {
+      block = span->free;
+      span->free = *(void**)(void*)block;
+    }
+  else
+    block = span->data + span->carved++ * class->size;
+  
+  class->used += 1;
+  if (++(span->used) == span->count)
+    {
+      class->partial = span->next;
+      if (span->next != NULL)
+	span->next->prev = NULL;
+      span->next = NULL;
+    }
+  
+  return block;
+}
+
+
+/**
+ * Return a block to the span it belongs to.
+ * The class must be locked.
+ * 
+ * @param  class  The size class.
+ * @param  block  The block.
+ */
+static void class_push(struct heap_class* class, char* block)
+{
+  struct heap_span* span = HEAP_SPAN(block);
+  
+  *(void**)(void*)block = span->free;
+  span->free = block;
+  class->used -= 1;
+  
+  if (span->used-- == span->count)
+    {
+      /* The span was full, and is not in the list. */
+      span->prev = NULL;
+      span->next = class->partial;
+      if (span->next != NULL)
+	span->next->prev = span;
+      class->partial = span;
+    }
+  else if ((span->used == 0) && ((span->prev != NULL) || (span->next != NULL)))
+    {
+      /* Keep one empty span so that alternating allocation
+       * and deallocation does not recycle the span every time. */
+      if (span->prev != NULL)
+	span->prev->next = span->next;
+      else
+	class->partial = span->next;
+      if (span->next != NULL)
+	span->next->prev = span->prev;
+      class->spans -= 1;
+      span_put(span);
+    }
+}
+
+
+/**
+ * Update the number of blocks a size class has
+ * in the threads' caches, with the number of
+ * blocks in the calling thread's cache.
+ * 
+ * This is only done when blocks are moved between
+ * the cache and the class, so that allocations and
+ * deallocations do not need to touch the class.
+ * The class need not be locked, as blocks can be
+ * moved to the transfer list without locking it.
+ * 
+ * @param  class  The size class.
+ * @param  bin    The calling thread's cache of the size class.
+ */
+static void cache_report(struct heap_class* class, struct heap_bin* bin)
+{
+  __atomic_add_fetch(&(class->cached), bin->count - bin->reported, __ATOMIC_RELAXED);
+  bin->reported = bin->count;
+}
+
+
+/**
+ * Add a list of batches to the transfer list of a size class.
+ * 
+ * @param  class  The size class.
+ * @param  first  The first batch in the list.
+ * @param  last   The last batch in the list.
+ */
+static void transfer_push(struct heap_class* class, void* first, void* last)
+{
+  void* head = __atomic_load_n(&(class->transfer), __ATOMIC_RELAXED);
+  do
+    ((void**)last)[1] = head;
+  while (!__atomic_compare_exchange_n(&(class->transfer), &head, first, 1,
+				      __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+
+/**
+ * Take a batch from the transfer list of a size class.
+ * 
+ * The entire list is taken, as that cannot be confused
+ * by other threads taking and adding batches meanwhile,
+ * and all but the first batch are added back.
+ * 
+ * @param   class  The size class.
+ * @return         The batch, `NULL` if the list is empty.
+ */
+static void* transfer_pop(struct heap_class* class)
+{
+  void* batch;
+  void* rest;
+  void* last;
+  
+  if (__atomic_load_n(&(class->transfer), __ATOMIC_RELAXED) == NULL)
+    return NULL;
+  batch = __atomic_exchange_n(&(class->transfer), NULL, __ATOMIC_ACQUIRE);
+  if (batch == NULL)
+    return NULL;
+  __atomic_sub_fetch(&(class->transfers), 1, __ATOMIC_RELAXED);
+  
+  rest = ((void**)batch)[1];
+  if (rest != NULL)
+    {
+      for (last = rest; ((void**)last)[1] != NULL;)
+	last = ((void**)last)[1];
+      transfer_push(class, rest, last);
+    }
+  return batch;
+}
+
+
+/**
+ * Move a batch of blocks from a size class to a cache.
+ * 
+ * A batch that another thread has moved to the
+ * class's transfer list is taken if there is one,
+ * so that blocks that are allocated by one thread
+ * and deallocated by another can be passed back
+ * without locking the class.
+ * 
+ * @param   cache  The cache.
+ * @param   index  The index of the size class.
+ * @return         Zero on success, -1 on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+static int cache_refill(struct heap_cache* cache, size_t index)
+{
+  struct heap_class* class = __slibc_heap_classes + index;
+  struct heap_bin* bin = cache->bins + index;
+  size_t i;
+  char* block;
+  
+  /* The cache is empty, so the batch becomes the cache.
+   * Its blocks are already counted in `class->cached`. */
+  block = transfer_pop(class);
+  if (block != NULL)
+    {
+      cache_report(class, bin);
+      bin->head = block;
+      bin->count += class->batch;
+      bin->reported += class->batch;
+      return 0;
+    }
+  
+  HEAP_LOCK(class->lock);
+  if (class->size == 0)
+    class_init(class, index);
+  for (i = 0; i < class->batch; i++)
+    {
+      block = class_pop(class, index);
+      if (block == NULL)
+	break;
+      *(void**)(void*)block = bin->head;
+      bin->head = block;
+    }
+  bin->count += i;
+  cache_report(class, bin);
+  HEAP_UNLOCK(class->lock);
+  
+  return i ? 0 : -1;
+}
+
+
+/**
+ * Move a batch of blocks from a cache
+ * back to their size class.
+ * 
+ * @param  cache  The cache.
+ * @param  index  The index of the size class.
+ * @param  count  The number of blocks to move.
+ */
+static void cache_flush(struct heap_cache* cache, size_t index, size_t count)
+{
+  struct heap_class* class = __slibc_heap_classes + index;
+  struct heap_bin* bin = cache->bins + index;
+  char* block;
+  
+  HEAP_LOCK(class->lock);
+  for (bin->count -= count; count--;)
+    {
+      block = bin->head;
+      bin->head = *(void**)(void*)block;
+      class_push(class, block);
+    }
+  cache_report(class, bin);
+  HEAP_UNLOCK(class->lock);
+}
+
+
+/**
+ * Move a batch of blocks from a cache to the
+ * transfer list of their size class, without
+ * locking the class. If the transfer list is
+ * full, the blocks are returned to their spans.
+ * 
+ * @param  cache  The cache.
+ * @param  index  The index of the size class.
+ */
+static void cache_release(struct heap_cache* cache, size_t index)
+{
+  struct heap_class* class = __slibc_heap_classes + index;
+  struct heap_bin* bin = cache->bins + index;
+  char* batch = bin->head;
+  char* last = batch;
+  size_t i;
+  
+  if (__atomic_load_n(&(class->transfers), __ATOMIC_RELAXED) >= HEAP_TRANSFER_MAX)
+    {
+      cache_flush(cache, index, class->batch);
+      return;
+    }
+  
+  for (i = 1; i < class->batch; i++)
+    last = *(void**)(void*)last;
+  bin->head = *(void**)(void*)last;
+  *(void**)(void*)last = NULL;
+  
+  /* The blocks remain counted in `class->cached`
+   * while they are in the transfer list. */
+  cache_report(class, bin);
+  bin->count -= class->batch;
+  bin->reported -= class->batch;
+  
+  __atomic_add_fetch(&(class->transfers), 1, __ATOMIC_RELAXED);
+  transfer_push(class, batch, batch);
+}
+
+
+/**
+ * Return the blocks in the transfer list of
+ * a size class to their spans.
+ * 
+ * @param  index  The index of the size class.
+ */
+static void transfer_drain(size_t index)
+{
+  struct heap_class* class = __slibc_heap_classes + index;
+  char* next_batch;
+  char* batch;
+  char* block;
+  char* next;
+  size_t n = 0;
+  
+  batch = __atomic_exchange_n(&(class->transfer), NULL, __ATOMIC_ACQUIRE);
+  if (batch == NULL)
+    return;
+  
+  HEAP_LOCK(class->lock);
+  for (; batch != NULL; batch = next_batch, n++)
+    {
+      next_batch = ((void**)(void*)batch)[1];
+      for (block = batch; block != NULL; block = next)
+	{
+	  next = *(void**)(void*)block;
+	  class_push(class, block);
+	}
+    }
+  __atomic_sub_fetch(&(class->cached), n * class->batch, __ATOMIC_RELAXED);
+  HEAP_UNLOCK(class->lock);
+  __atomic_sub_fetch(&(class->transfers), n, __ATOMIC_RELAXED);
+}
+
+
+/**
+ * Get the cache the calling thread shall use, and
+ * lock it if it is a per-CPU cache.
+ * 
+ * If the per-CPU cache is already locked, because
+ * a thread was preempted or migrated while using it,
+ * the calling thread's own cache is used rather than
+ * waiting for it. Only threads that have collided
+ * with another thread will thus have blocks cached
+ * outside the per-CPU caches.
+ * 
+ * @return  The cache.
+ */
+__GCC_ONLY(__attribute__((__always_inline__)))
+static inline struct heap_cache* cache_get(void)
+{
+  struct heap_cache* caches = __atomic_load_n(&cpu_caches, __ATOMIC_ACQUIRE);
+  struct heap_cache* cache;
+  int cpu;
+  
+  if (__builtin_expect(caches == NULL, 1))
+    return &heap_cache;
+  
+  cpu = sched_getcpu();
+  cache = caches + (cpu < 0 ? 0 : (size_t)cpu % cpu_count);
+  if (__atomic_test_and_set(&(cache->lock), __ATOMIC_ACQUIRE))
+    return &heap_cache;
+  return cache;
+}
+
+
+/**
+ * Release a cache returned by `cache_get`.
+ * 
+ * @param  cache  The cache.
+ */
+static inline void cache_unget(struct heap_cache* cache)
+{
+  if (cache != &heap_cache)
+    HEAP_UNLOCK(cache->lock);
+}
+
+
+/**
+ * Get the block of a size class that a pointer points into.
+ * 
+ * The span's header is not read, so that no cache
+ * miss is taken if the size class is already known.
+ * 
+ * @param   index  The index of the size class of the block.
+ * @param   ptr    Pointer to the block, or into the block.
+ * @return         The block.
+ */
+__GCC_ONLY(__attribute__((__always_inline__)))
+static inline char* block_of(size_t index, void* ptr)
+{
+  struct heap_class* class = __slibc_heap_classes + index;
+  char* data = (char*)HEAP_SPAN(ptr) + class->offset;
+  uint64_t offset = (uint64_t)((char*)ptr - data);
+  return data + (size_t)((offset * class->reciprocal) >> 32) * class->size;
+}
+
+
+/**
+ * Allocate a block from a size class, without
+ * recording the size the user requested.
+ * 
+ * @param   index  The index of the size class.
+ * @return         The block, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+static void* small_alloc(size_t index)
+{
+  struct heap_cache* cache = cache_get();
+  struct heap_bin* bin = cache->bins + index;
+  char* block;
+  
+  if ((bin->head == NULL) && cache_refill(cache, index))
+    {
+      cache_unget(cache);
+      return NULL;
+    }
+  
+  block = bin->head;
+  bin->head = *(void**)(void*)block;
+  bin->count -= 1;
+  cache_unget(cache);
+  
+  return block;
+}
+
+
+/**
+ * Put a block in a cache, without returning any
+ * blocks to the size class if the cache becomes
+ * too large.
+ * 
+ * @param   cache  The cache.
+ * @param   index  The index of the size class of the block.
+ * @param   ptr    Pointer to the block, or into the block.
+ * @return         The cache of the size class.
+ */
+__GCC_ONLY(__attribute__((__always_inline__)))
+static inline struct heap_bin* cache_put(struct heap_cache* cache, size_t index, void* ptr)
+{
+  struct heap_bin* bin = cache->bins + index;
+  char* block = block_of(index, ptr);
+  
+  *(void**)(void*)block = bin->head;
+  bin->head = block;
+  bin->count += 1;
+  return bin;
+}
+
+
+/**
+ * Return a block to the cache the calling thread uses.
+ * 
+ * @param  index  The index of the size class of the block.
+ * @param  ptr    Pointer to the block, or into the block.
+ */
+static void small_free(size_t index, void* ptr)
+{
+  struct heap_cache* cache = cache_get();
+  struct heap_bin* bin = cache_put(cache, index, ptr);
+  if (bin->count > 2 * __slibc_heap_classes[index].batch)
+    cache_release(cache, index);
+  cache_unget(cache);
+}
+
+
+/**
+ * Return all blocks in a cache to their size classes.
+ * 
+ * @param  cache  The cache.
+ */
+static void cache_flush_all(struct heap_cache* cache)
+{
+  size_t index;
+  for (index = 0; index < HEAP_CLASS_COUNT; index++)
+    if (cache->bins[index].count)
+      cache_flush(cache, index, cache->bins[index].count);
+}
+
+
+/**
+ * Return all blocks in the calling thread's
+ * cache to their size classes.
+ */
+void __slibc_heap_flush_cache(void)
+{
+  cache_flush_all(&heap_cache);
+}
+
+
+/**
+ * Use per-CPU caches, instead of per-thread caches,
+ * for all threads. This cannot be undone.
+ * 
+ * The blocks in the calling thread's cache are returned
+ * to their size classes, other threads' caches are not
+ * flushed until the threads exit.
+ * 
+ * @param   use  Whether per-CPU caches shall be used.
+ * @return       Zero on success, -1 on error.
+ * 
+ * @throws  ENOMEM  `use` is non-zero, and the process
+ *                  cannot allocate more memory.
+ * @throws  EINVAL  `use` is zero, but per-CPU caches
+ *                  are already used.
+ */
+int __slibc_heap_use_cpu_caches(int use)
+{
+  size_t pagesize = __slibc_heap_pagesize();
+  struct heap_cache* caches;
+  struct heap_cache* expected = NULL;
+  size_t count, size;
+  long n;
+  
+  if (__atomic_load_n(&cpu_caches, __ATOMIC_ACQUIRE) != NULL)
+    return use ? 0 : (errno = EINVAL, -1);
+  if (!use)
+    return 0;
+  
+  n = sysconf(_SC_NPROCESSORS_CONF);
+  count = n < 1 ? 1 : (size_t)n;
+  OVERFLOW(umull, count, sizeof(struct heap_cache), &size, ENOMEM, -1);
+  size = (size + pagesize - 1) & ~(pagesize - 1);
+  caches = (struct heap_cache*)(void*)map_aligned(size, pagesize, 0);
+  if (caches == NULL)
+    return -1;
+  
+  /* `cpu_count` is written before `cpu_caches`
+   * is published, and any thread that races
+   * with this one will write the same value. */
+  cpu_count = count;
+  if (!__atomic_compare_exchange_n(&cpu_caches, &expected, caches, 0,
+				   __ATOMIC_RELEASE, __ATOMIC_RELAXED))
+    {
+      HEAP_COUNT(munmap_calls, 1);
+      munmap(caches, size);
+      return 0;
+    }
+  
+  __slibc_heap_flush_cache();
+  return 0;
+}
+
+
+/**
+ * Set `__slibc_heap_mmap_threshold`.
+ * 
+ * @param   threshold  The new threshold.
+ * @return             Zero on success, -1 on error.
+ * 
+ * @throws  EINVAL  `threshold` is greater than `HEAP_SMALL_MAX`.
+ */
+int __slibc_heap_set_mmap_threshold(size_t threshold)
+{
+  size_t min = __atomic_load_n(&mmap_threshold_min, __ATOMIC_RELAXED);
+  
+  if (threshold > HEAP_SMALL_MAX)
+    return errno = EINVAL, -1;
+  
+  /* `mmap_threshold_min` is lowered first, so that
+   * `__slibc_heap_free_sized` never misses an allocation
+   * that was made with the new threshold. */
+  while ((threshold < min) &&
+	 !__atomic_compare_exchange_n(&mmap_threshold_min, &min, threshold, 1,
+				      __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+  __atomic_store_n(&__slibc_heap_mmap_threshold, threshold, __ATOMIC_RELEASE);
+  return 0;
+}
+
+
+/**
+ * Remove a mapping from `retained`.
+ * `retain_lock` must be held.
+ * 
+ * @param  span  The mapping.
+ */
+static void retained_unlink(struct heap_span* span)
+{
+  if (span->prev != NULL)
+    span->prev->next = span->next;
+  else
+    retained = span->next;
+  if (span->next != NULL)
+    span->next->prev = span->prev;
+  else
+    retained_last = span->prev;
+  retained_count -= 1;
+  retained_bytes -= span->block_size;
+}
+
+
+/**
+ * Add a mapping to the end of `retained`.
+ * `retain_lock` must be held.
+ * 
+ * @param  span  The mapping.
+ */
+static void retained_append(struct heap_span* span)
+{
+  span->next = NULL;
+  span->prev = retained_last;
+  if (retained_last != NULL)
+    retained_last->next = span;
+  else
+    retained = span;
+  retained_last = span;
+  retained_count += 1;
+  retained_bytes += span->block_size;
+}
+
+
+/**
+ * Check whether a mapping, that is kept for reuse,
+ * has pages that have not been returned to the kernel.
+ * 
+ * @param   span  The mapping.
+ * @return        Whether the mapping has dirty pages.
+ */
+static inline int retained_dirty(struct heap_span* span)
+{
+  return span->zero > __slibc_heap_pagesize();
+}
+
+
+/**
+ * Return the pages of a mapping, that is kept for reuse,
+ * to the kernel, except for the page with the header.
+ * The mapping must not be in `retained`.
+ * 
+ * @param  span  The mapping.
+ */
+static void retained_purge(struct heap_span* span)
+{
+  size_t start = __slibc_heap_pagesize();
+  if (!retained_dirty(span))
+    return;
+  HEAP_COUNT(purge_calls, 1);
+  if (!madvise((char*)span + start, span->block_size - start, MADV_DONTNEED))
+    span->zero = start;
+}
+
+
+/**
+ * Get the time mappings in `retained` decay by.
+ * 
+ * @return  The time, in milliseconds, on the monotonic clock.
+ */
+static size_t retain_now(void)
+{
+  struct timespec now;
+  if (clock_gettime(CLOCK_MONOTONIC, &now))
+    return 0;
+  return (size_t)now.tv_sec * 1000 + (size_t)now.tv_nsec / 1000000;
+}
+
+
+/**
+ * Return the pages of the mappings in `retained`, that
+ * were kept `__slibc_heap_retain_decay` milliseconds
+ * ago or earlier, to the kernel.
+ * 
+ * @param  now  The current time, see `retain_now`.
+ */
+static void retained_decay(size_t now)
+{
+  size_t decay = __slibc_heap_retain_decay;
+  struct heap_span* decayed = NULL;
+  struct heap_span* span;
+  struct heap_span* next;
+  
+  /* `retained` is ordered by age, the oldest last. Mappings that
+   * were kept by other threads after `now` was read are newer
+   * than all mappings that may have decayed. */
+  HEAP_LOCK(retain_lock);
+  for (span = retained_last; span != NULL; span = next)
+    {
+      next = span->prev;
+      if ((span->retired > now) || (now - span->retired < decay))
+	break;
+      if (retained_dirty(span))
+	{
+	  retained_unlink(span);
+	  span->next = decayed;
+	  decayed = span;
+	}
+    }
+  HEAP_UNLOCK(retain_lock);
+  
+  if (decayed == NULL)
+    return;
+  for (span = decayed; span != NULL; span = span->next)
+    retained_purge(span);
+  HEAP_LOCK(retain_lock);
+  for (; decayed != NULL; decayed = next)
+    {
+      next = decayed->next;
+      retained_append(decayed);
+    }
+  HEAP_UNLOCK(retain_lock);
+}
+
+
+/**
+ * Return the pages of the mappings, that have been kept
+ * for reuse for `__slibc_heap_retain_decay` milliseconds,
+ * to the kernel.
+ */
+void __slibc_heap_decay(void)
+{
+  if (__atomic_load_n(&retained_last, __ATOMIC_RELAXED) != NULL)
+    retained_decay(retain_now());
+}
+
+
+/**
+ * Unmap a mapping, that is kept for reuse.
+ * The mapping must not be in `retained`.
+ * 
+ * @param  span  The mapping.
+ */
+static void retained_unmap(struct heap_span* span)
+{
+  HEAP_COUNT(large_retained, -(span->block_size));
+  HEAP_COUNT(munmap_calls, 1);
+  munmap(span, span->block_size);
+}
+
+
+/**
+ * Take the smallest mapping, that is kept for reuse,
+ * that is large enough for an allocation, but not
+ * more than twice as large as needed. Pages after
+ * the needed size are unmapped.
+ * 
+ * @param   map_size  The size the mapping needs.
+ * @return            The mapping, `NULL` if none is suitable.
+ */
+static struct heap_span* retained_take(size_t map_size)
+{
+  struct heap_span* span;
+  struct heap_span* best = NULL;
+  
+  HEAP_LOCK(retain_lock);
+  for (span = retained; span != NULL; span = span->next)
+    {
+      if ((span->block_size < map_size) || (span->block_size - map_size > map_size))
+	continue;
+      if ((best == NULL) || (span->block_size < best->block_size))
+	best = span;
+      if (best->block_size == map_size)
+	break;
+    }
+  if (best != NULL)
+    retained_unlink(best);
+  HEAP_UNLOCK(retain_lock);
+  
+  if (best == NULL)
+    return NULL;
+  
+  HEAP_COUNT(large_retained, -(best->block_size));
+  if (best->block_size > map_size)
+    {
+      HEAP_COUNT(munmap_calls, 1);
+      munmap((char*)best + map_size, best->block_size - map_size);
+      if (best->zero > map_size)
+	best->zero = map_size;
+    }
+  return best;
+}
+
+
+/**
+ * Keep the mapping of a deallocated large allocation
+ * for reuse, and return the pages of mappings that
+ * have not been reused for a while to the kernel.
+ * 
+ * System calls are made without holding `retain_lock`,
+ * mappings that are being purged are removed from
+ * `retained` meanwhile, so that they are not reused.
+ * 
+ * @param  span  The mapping of the deallocated allocation.
+ */
+static void retain(struct heap_span* span)
+{
+  struct heap_span* evicted = NULL;
+  struct heap_span* next;
+  size_t now;
+  
+  if (span->block_size > HEAP_RETAIN_MAX)
+    {
+      HEAP_COUNT(munmap_calls, 1);
+      munmap(span, span->block_size);
+      return;
+    }
+  HEAP_COUNT(large_retained, span->block_size);
+  large_written(span, span->block_size);
+  now = retain_now();
+  
+  HEAP_LOCK(retain_lock);
+  span->retired = now;
+  span->prev = NULL;
+  span->next = retained;
+  if (retained != NULL)
+    retained->prev = span;
+  else
+    retained_last = span;
+  retained = span;
+  retained_count += 1;
+  retained_bytes += span->block_size;
+  
+  while ((retained_count > HEAP_RETAIN_COUNT) || (retained_bytes > HEAP_RETAIN_BYTES))
+    {
+      span = retained_last;
+      retained_unlink(span);
+      span->next = evicted;
+      evicted = span;
+    }
+  HEAP_UNLOCK(retain_lock);
+  
+  for (; evicted != NULL; evicted = next)
+    {
+      next = evicted->next;
+      retained_unmap(evicted);
+    }
+  
+  retained_decay(now);
+}
+
+
+/**
+ * Create an allocation with its own memory mapping.
+ * 
+ * @param   boundary  The alignment, must be a power of two.
+ * @param   size      The size of the allocation.
+ * @return            The allocation, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+static void* large_alloc(size_t boundary, size_t size)
+{
+  size_t pagesize = __slibc_heap_pagesize();
+  size_t offset, alignment = HEAP_SPAN_SIZE, skew = 0;
+  size_t map_size;
+  struct heap_span* span;
+  int huge;
+  
+  /* The pointer must be within the first span-size
+   * bytes of the mapping, for `HEAP_SPAN` to work. */
+  if (boundary <= HEAP_SPAN_SIZE)
+    offset = (HEAP_LARGE_OFFSET + boundary - 1) & ~(boundary - 1);
+  else
+    offset = skew = HEAP_SPAN_SIZE, alignment = boundary;
+  
+  MEM_OVERFLOW(uaddl, offset, size, &map_size);
+  MEM_OVERFLOW(uaddl, map_size, pagesize - 1, &map_size);
+  map_size &= ~(pagesize - 1);
+  
+  /* Mappings are aligned to the span size, so any mapping
+   * that is kept for reuse can be used unless the
+   * allocation needs a skewed mapping. Its pages
+   * are usually still mapped in, so no page faults
+   * are taken when the allocation is used. */
+  span = skew ? NULL : retained_take(map_size);
+  if (span != NULL)
+    goto reused;
+  
+  /* Huge pages must be aligned. If `boundary` requires a skewed
+   * mapping, the huge pages inside the mapping are still used. */
+  huge = __slibc_heap_huge_threshold && (map_size >= __slibc_heap_huge_threshold);
+  if (huge && !skew)
+    alignment = HEAP_HUGE_PAGE_SIZE;
+  
+  span = (struct heap_span*)(void*)map_aligned(map_size, alignment, skew);
+  if (span == NULL)
+    return NULL;
+  span->zero = offset;
+  span->huge = huge && !madvise(span, map_size, MADV_HUGEPAGE);
+ 
+ reused:
+  span->class      = 0;
+  span->block_size = map_size;
+  span->data       = (char*)span + offset;
+  span->sizes      = NULL;
+  span->size       = size;
+  if (span->huge)
+    __atomic_add_fetch(&__slibc_heap_huge_bytes, huge_bytes(span, map_size), __ATOMIC_RELAXED);
+  HEAP_COUNT(large_count, 1);
+  HEAP_COUNT(large_mapped, map_size);
+  HEAP_COUNT(large_in_use, size);
+  
+  /* Decay here too, for programs that stop deallocating
+   * large allocations, after the mapping is taken so
+   * that its pages are not returned in vain. */
+  __slibc_heap_decay();
+  return span->data;
+}
+
+
+/**
+ * Deallocate a large allocation. Its mapping
+ * is kept for reuse, unless it is too large.
+ * 
+ * @param  span  The large allocation.
+ */
+static void large_free(struct heap_span* span)
+{
+  if (span->huge)
+    __atomic_sub_fetch(&__slibc_heap_huge_bytes, huge_bytes(span, span->block_size),
+		       __ATOMIC_RELAXED);
+  HEAP_COUNT(large_count, -1);
+  HEAP_COUNT(large_mapped, -(span->block_size));
+  HEAP_COUNT(large_in_use, -(span->size));
+  retain(span);
+}
+
+
+/**
+ * Create a new allocation, without initialising it.
+ * 
+ * @param   size  The size of the allocation, must not be zero.
+ * @return        The new allocation, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+void* __slibc_heap_alloc(size_t size)
+{
+  void* ptr;
+  if (size > __slibc_heap_mmap_threshold)
+    ptr = large_alloc(HEAP_QUANTUM, size);
+  else if ((ptr = small_alloc(heap_class_of(size))) != NULL)
+    heap_set_size(ptr, size);
+  return HEAP_SAMPLE(ptr, size);
+}
+
+
+/**
+ * Create a new aligned allocation, without initialising
+ * it, and without recording its size if it is small.
+ * 
+ * @param   boundary  The alignment, must be a power of two.
+ * @param   size      The size of the allocation, must not be zero.
+ * @return            The new allocation, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+static void* unsized_alloc(size_t boundary, size_t size)
+{
+  size_t index;
+  char* ptr;
+  
+  if (boundary <= HEAP_QUANTUM)
+    index = size <= __slibc_heap_mmap_threshold ? heap_class_of(size) : HEAP_CLASS_COUNT;
+  else if (size <= __slibc_heap_mmap_threshold)
+    index = heap_aligned_class_of(boundary, size);
+  else
+    index = HEAP_CLASS_COUNT;
+  if (index == HEAP_CLASS_COUNT)
+    return large_alloc(boundary > HEAP_QUANTUM ? boundary : HEAP_QUANTUM, size);
+  
+  /* The pointer is only shifted if the block is not
+   * naturally aligned. Any pointer into a block
+   * identifies the block, so it can be freed. */
+  ptr = small_alloc(index);
+  if ((ptr == NULL) || (boundary <= HEAP_QUANTUM))
+    return ptr;
+  return (void*)(((size_t)ptr + boundary - 1) & ~(size_t)(boundary - 1));
+}
+
+
+/**
+ * Create a new aligned allocation, without initialising it.
+ * 
+ * @param   boundary  The alignment, must be a power of two.
+ * @param   size      The size of the allocation, must not be zero.
+ * @return            The new allocation, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+void* __slibc_heap_alloc_aligned(size_t boundary, size_t size)
+{
+  void* ptr;
+  
+  if (boundary <= HEAP_QUANTUM)
+    return __slibc_heap_alloc(size);
+  
+  ptr = unsized_alloc(boundary, size);
+  if (ptr != NULL)
+    heap_set_size(ptr, size);
+  return HEAP_SAMPLE(ptr, size);
+}
+
+
+/**
+ * Create a new aligned allocation, without initialising it,
+ * whose size is kept track of by the caller. No size is
+ * recorded for small allocations, so they may only be
+ * inspected or resized with the functions that take the
+ * size as an argument, and must be deallocated with
+ * `__slibc_heap_free_sized`.
+ * 
+ * @param   boundary  The alignment, must be a power of two.
+ * @param   size      The size of the allocation, must not be zero.
+ * @return            The new allocation, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+void* __slibc_heap_alloc_unsized(size_t boundary, size_t size)
+{
+  return HEAP_SAMPLE(unsized_alloc(boundary, size), size);
+}
+
+
+/**
+ * Create a number of allocations of the same size,
+ * without initialising them.
+ * 
+ * Small allocations are taken from the calling thread's
+ * cache if it has enough blocks, otherwise they are all
+ * taken from the size class while it is locked once.
+ * In the latter case, blocks that are carved from a
+ * span, rather than reused, are adjacent in memory.
+ * 
+ * @param   size   The size of each allocation, must not be zero.
+ * @param   count  The number of allocations.
+ * @param   ptrs   Output array for the allocations.
+ * @return         The number of allocations that were created,
+ *                 they are stored at the beginning of `ptrs`.
+ *                 Less than `count` is returned on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+size_t __slibc_heap_alloc_batch(size_t size, size_t count, void** ptrs)
+{
+  struct heap_class* class;
+  struct heap_cache* cache;
+  struct heap_bin* bin;
+  size_t i, index;
+  char* block;
+  
+  if (size > __slibc_heap_mmap_threshold)
+    {
+      for (i = 0; i < count; i++)
+	if ((ptrs[i] = large_alloc(HEAP_QUANTUM, size)) == NULL)
+	  break;
+      goto done;
+    }
+  
+  index = heap_class_of(size);
+  class = __slibc_heap_classes + index;
+  cache = cache_get();
+  bin = cache->bins + index;
+  
+  if (count <= bin->count)
+    for (i = 0; i < count; i++)
+      {
+	ptrs[i] = block = bin->head;
+	bin->head = *(void**)(void*)block;
+	bin->count -= 1;
+      }
+  else
+    {
+      HEAP_LOCK(class->lock);
+      if (class->size == 0)
+	class_init(class, index);
+      for (i = 0; i < count; i++)
+	if ((ptrs[i] = class_pop(class, index)) == NULL)
+	  break;
+      cache_report(class, bin);
+      HEAP_UNLOCK(class->lock);
+    }
+  cache_unget(cache);
+  
+  for (index = 0; index < i; index++)
+    heap_set_size(ptrs[index], size);
+ 
+ done:
+  for (index = 0; index < i; index++)
+    ptrs[index] = HEAP_SAMPLE(ptrs[index], size);
+  return i;
+}
+
+
+/**
+ * Resize an allocation without moving it.
+ * 
+ * Small allocations can grow into the unused part of their
+ * block, large allocations can grow if the pages after the
+ * mapping are not mapped.
+ * 
+ * @param   ptr   The allocation, must not be `NULL`.
+ * @param   size  The new size of the allocation, must not be zero.
+ * @return        `ptr` on success, `NULL` with `errno` set to
+ *                zero if the allocation must be moved.
+ * 
+ * @throws  0  The allocation cannot be resized in place.
+ */
+void* __slibc_heap_resize(void* ptr, size_t size)
+{
+  struct heap_span* span = HEAP_SPAN(ptr);
+  struct heap_class* class;
+  size_t index, map_size;
+  
+  /* An allocation must stay in the size class its size
+   * maps to, so that `__slibc_heap_free_sized` can find
+   * the size class from the size. Blocks whose pointers
+   * are shifted for alignment are therefore not resized. */
+  if (span->class)
+    {
+      class = __slibc_heap_classes + span->class - 1;
+      index = heap_block_index(span, class, ptr);
+      if ((heap_class_of(size) != span->class - 1) || ((char*)ptr != span->data + index * class->size))
+	return errno = 0, NULL;
+      span->sizes[index] = (uint16_t)size;
+      return ptr;
+    }
+  if (size <= HEAP_SMALL_MAX)
+    return errno = 0, NULL;
+  
+  if (__builtin_uaddl_overflow((size_t)((char*)ptr - (char*)span), size, &map_size) ||
+      __builtin_uaddl_overflow(map_size, __slibc_heap_pagesize() - 1, &map_size))
+    return errno = 0, NULL;
+  map_size &= ~(__slibc_heap_pagesize() - 1);
+  
+  if (map_size != span->block_size)
+    {
+      HEAP_COUNT(mremap_calls, 1);
+      if (mremap(span, span->block_size, map_size, 0) == MAP_FAILED)
+	return errno = 0, NULL;
+      large_written(span, map_size);
+      if (span->huge)
+	__atomic_add_fetch(&__slibc_heap_huge_bytes,
+			   huge_bytes(span, map_size) - huge_bytes(span, span->block_size),
+			   __ATOMIC_RELAXED);
+      HEAP_COUNT(large_mapped, map_size - span->block_size);
+      span->block_size = map_size;
+    }
+  else
+    large_written(span, map_size);
+  HEAP_COUNT(large_in_use, size - span->size);
+  span->size = size;
+  return ptr;
+}
+
+
+/**
+ * Resize an allocation created with `__slibc_heap_alloc_unsized`
+ * without moving it. A small allocation can only be resized within
+ * the size class that `__slibc_heap_free_sized` will look for, and
+ * its size is not recorded.
+ * 
+ * @param   ptr       The allocation, must not be `NULL`.
+ * @param   boundary  The alignment the allocation was created with.
+ * @param   size      The new size of the allocation, must not be zero.
+ * @return            `ptr` on success, `NULL` with `errno` set to
+ *                    zero if the allocation must be moved.
+ * 
+ * @throws  0  The allocation cannot be resized in place.
+ */
+void* __slibc_heap_resize_unsized(void* ptr, size_t boundary, size_t size)
+{
+  struct heap_span* span = HEAP_SPAN(ptr);
+  size_t index;
+  
+  if (span->class == 0)
+    return __slibc_heap_resize(ptr, size);
+  
+  if (boundary > HEAP_QUANTUM)
+    index = heap_aligned_class_of(boundary, size);
+  else
+    index = size <= HEAP_SMALL_MAX ? heap_class_of(size) : HEAP_CLASS_COUNT;
+  if (index != (size_t)(span->class - 1))
+    return errno = 0, NULL;
+  return ptr;
+}
+
+
+/**
+ * Resize an allocation without copying its content.
+ * 
+ * If the allocation cannot be resized in place, but it
+ * is a large allocation, its pages are moved to a new
+ * address, and the old pointer becomes invalid.
+ * 
+ * @param   ptr       The allocation, must not be `NULL`.
+ * @param   boundary  The alignment, of the new pointer, if it is moved.
+ * @param   size      The new size of the allocation, must not be zero.
+ * @return            `ptr`, or the new pointer, on success, `NULL` with
+ *                    `errno` set to zero if the content must be copied
+ *                    to a new allocation, `NULL` on error.
+ * 
+ * @throws  0       The allocation is not a large allocation, or
+ *                  it cannot be moved with the requested alignment.
+ * @throws  EINVAL  `boundary` is not a power of two.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+void* __slibc_heap_move(void* ptr, size_t boundary, size_t size)
+{
+  struct heap_span* span = HEAP_SPAN(ptr);
+  struct heap_span* new_span;
+  size_t pagesize = __slibc_heap_pagesize();
+  size_t offset = (size_t)((char*)ptr - (char*)span);
+  size_t alignment = HEAP_SPAN_SIZE, skew = 0;
+  size_t map_size, old_huge;
+  void* new_ptr;
+  
+  new_ptr = __slibc_heap_resize(ptr, size);
+  if (new_ptr != NULL)
+    return HEAP_COUNT(realloc_in_place, 1), new_ptr;
+  if (span->class || (size <= HEAP_SMALL_MAX))
+    return errno = 0, NULL;
+  
+  if (!boundary || (boundary & (boundary - 1)))
+    return errno = EINVAL, NULL;
+  if (boundary > HEAP_SPAN_SIZE)
+    alignment = boundary, skew = HEAP_SPAN_SIZE;
+  if ((boundary > HEAP_SPAN_SIZE) ? (offset != HEAP_SPAN_SIZE) : (offset % boundary))
+    return errno = 0, NULL;
+  
+  MEM_OVERFLOW(uaddl, offset, size, &map_size);
+  MEM_OVERFLOW(uaddl, map_size, pagesize - 1, &map_size);
+  map_size &= ~(pagesize - 1);
+  
+  /* The advice follows the pages, but the new
+   * address must be aligned for them to be huge. */
+  if (span->huge && !skew)
+    alignment = HEAP_HUGE_PAGE_SIZE;
+  old_huge = huge_bytes(span, span->block_size);
+  
+  /* Reserve an aligned address, and let the kernel move the
+   * pages there. The pages are moved, not copied, and the
+   * reservation is replaced by them. */
+  new_span = (struct heap_span*)(void*)map_aligned(map_size, alignment, skew);
+  if (new_span == NULL)
+    return NULL;
+  HEAP_COUNT(mremap_calls, 1);
+  if (mremap(span, span->block_size, map_size, MREMAP_MAYMOVE | MREMAP_FIXED, new_span) == MAP_FAILED)
+    {
+      HEAP_COUNT(munmap_calls, 1);
+      munmap(new_span, map_size);
+      return NULL;
+    }
+  
+  HEAP_COUNT(large_mapped, map_size - new_span->block_size);
+  HEAP_COUNT(large_in_use, size - new_span->size);
+  HEAP_COUNT(realloc_moved, 1);
+  new_span->block_size = map_size;
+  new_span->data       = (char*)new_span + offset;
+  large_written(new_span, map_size);
+  new_span->size       = size;
+  if (__builtin_expect(__slibc_heapprof_live != 0, 0))
+    __slibc_heapprof_move(ptr, new_span->data);
+  if (new_span->huge)
+    __atomic_add_fetch(&__slibc_heap_huge_bytes, huge_bytes(new_span, map_size) - old_huge,
+		       __ATOMIC_RELAXED);
+  return new_span->data;
+}
+
+
+/**
+ * Clear a part of an allocation that the user has not
+ * written to yet, without touching memory that is
+ * known to be zero already.
+ * 
+ * Large allocations are created with fresh mappings, which
+ * the kernel has already cleared, and that is remembered
+ * when they are resized, so the pages are not touched,
+ * and are only allocated when the user writes to them.
+ * The content is not secret, so `memset` is used rather
+ * than `explicit_bzero`.
+ * 
+ * @param  ptr     The allocation, must not be `NULL`.
+ * @param  offset  The offset of the part in the allocation.
+ * @param  size    The size of the part.
+ */
+void __slibc_heap_clear(void* ptr, size_t offset, size_t size)
+{
+  struct heap_span* span = HEAP_SPAN(ptr);
+  size_t start, zero;
+  
+  if (span->class == 0)
+    {
+      start = (size_t)((char*)ptr - (char*)span) + offset;
+      zero = span->zero;
+      if (zero <= start)
+	return;
+      if (size > zero - start)
+	size = zero - start;
+    }
+  memset((char*)ptr + offset, 0, size);
+}
+
+
+/**
+ * Override a part of an allocation with zeroes,
+ * in a way that cannot be removed by the compiler.
+ * 
+ * Unlike `explicit_bzero`, the memory is only written
+ * once. Whole pages in large allocations whose mappings
+ * are too large to be kept for reuse are not written at
+ * all, instead they are returned to the kernel, which
+ * replaces them with zeroed pages if they are used again.
+ * Smaller mappings are likely to be reused, and taking
+ * page faults then would cost more than writing the pages.
+ * 
+ * @param  ptr     The allocation, must not be `NULL`.
+ * @param  offset  The offset of the part in the allocation.
+ * @param  size    The size of the part.
+ */
+void __slibc_heap_wipe(void* ptr, size_t offset, size_t size)
+{
+  struct heap_span* span = HEAP_SPAN(ptr);
+  size_t pagesize = __slibc_heap_pagesize();
+  char* start = (char*)ptr + offset;
+  char* end = start + size;
+  char* first;
+  char* last;
+  
+  if ((span->class == 0) && (span->block_size > HEAP_RETAIN_MAX))
+    {
+      first = (char*)(((size_t)start + pagesize - 1) & ~(pagesize - 1));
+      last = (char*)((size_t)end & ~(pagesize - 1));
+      if ((first < last) && !madvise(first, (size_t)(last - first), MADV_DONTNEED))
+	{
+	  HEAP_COUNT(purge_calls, 1);
+	  __slibc_explicit_memset(start, 0, (size_t)(first - start));
+	  __slibc_explicit_memset(last, 0, (size_t)(end - last));
+	  return;
+	}
+    }
+  
+  __slibc_explicit_memset(start, 0, size);
+}
+
+
+/**
+ * Deallocate an allocation.
+ * 
+ * @param  ptr  The allocation, must not be `NULL`.
+ */
+void __slibc_heap_free(void* ptr)
+{
+  struct heap_span* span = HEAP_SPAN(ptr);
+  if (__builtin_expect(__slibc_heapprof_live != 0, 0))
+    __slibc_heapprof_forget(ptr);
+  if (span->class)
+    small_free(span->class - 1, ptr);
+  else
+    large_free(span);
+}
+
+
+/**
+ * Deallocate an allocation whose size, and alignment,
+ * is known, without reading the header of its span
+ * unless it is a large allocation.
+ * 
+ * @param  ptr       The allocation, must not be `NULL`.
+ * @param  boundary  The alignment the allocation was created
+ *                   with, any value up to `HEAP_QUANTUM` if it
+ *                   was not created with a specific alignment.
+ * @param  size      The size of the allocation.
+ */
+void __slibc_heap_free_sized(void* ptr, size_t boundary, size_t size)
+{
+  size_t index;
+  if (__builtin_expect(__slibc_heapprof_live != 0, 0))
+    __slibc_heapprof_forget(ptr);
+  if (boundary > HEAP_QUANTUM)
+    index = heap_aligned_class_of(boundary, size);
+  else
+    index = size <= HEAP_SMALL_MAX ? heap_class_of(size) : HEAP_CLASS_COUNT;
+  /* The size may have been above the mmap threshold when
+   * the allocation was created, even if it is not now. */
+  if ((index < HEAP_CLASS_COUNT) && (size > mmap_threshold_min) && (HEAP_SPAN(ptr)->class == 0))
+    index = HEAP_CLASS_COUNT;
+  if (index < HEAP_CLASS_COUNT)
+    small_free(index, ptr);
+  else
+    large_free(HEAP_SPAN(ptr));
+}
+
+
+/**
+ * Deallocate a number of allocations.
+ * 
+ * Small allocations are put in the calling thread's
+ * cache, and the blocks the cache cannot keep are
+ * returned to their size classes afterwards, so
+ * that each size class is locked at most once.
+ * Large allocations are deallocated after the
+ * cache is released, so that no system call is
+ * made while a per-CPU cache is locked.
+ * 
+ * @param  ptrs   The allocations, `NULL`s are ignored.
+ * @param  count  The number of elements in `ptrs`.
+ */
+void __slibc_heap_free_batch(void** ptrs, size_t count)
+{
+  uint64_t classes = 0;
+  struct heap_span* span;
+  struct heap_span* large = NULL;
+  struct heap_class* class;
+  struct heap_cache* cache;
+  struct heap_bin* bin;
+  size_t i, index;
+  
+  if (__builtin_expect(__slibc_heapprof_live != 0, 0))
+    for (i = 0; i < count; i++)
+      if (ptrs[i] != NULL)
+	__slibc_heapprof_forget(ptrs[i]);
+  
+  cache = cache_get();
+  for (i = 0; i < count; i++)
+    {
+      if (ptrs[i] == NULL)
+	continue;
+      span = HEAP_SPAN(ptrs[i]);
+      if (span->class == 0)
+	{
+	  /* `next` is unused while the allocation is live. */
+	  span->next = large;
+	  large = span;
+	  continue;
+	}
+      index = span->class - 1;
+      cache_put(cache, index, ptrs[i]);
+      classes |= (uint64_t)1 << index;
+    }
+  
+  for (; classes; classes &= classes - 1)
+    {
+      index = (size_t)__builtin_ctzll(classes);
+      class = __slibc_heap_classes + index;
+      bin = cache->bins + index;
+      if (bin->count > 2 * class->batch)
+	cache_flush(cache, index, bin->count - class->batch);
+    }
+  cache_unget(cache);
+  
+  while (large != NULL)
+    {
+      span = large;
+      large = span->next;
+      large_free(span);
+    }
+}
+
+
+/**
+ * Return unused memory to the kernel.
+ * 
+ * Mappings of deallocated large allocations, that are
+ * kept for reuse, are unmapped, the least recently
+ * deallocated first, and the pages of spans that no
+ * size class uses are returned to the kernel.
+ * 
+ * @param   pad  The number of bytes in mappings of deallocated
+ *               large allocations that may be kept for reuse.
+ * @return       1 if any memory was returned, 0 otherwise.
+ */
+int __slibc_heap_trim(size_t pad)
+{
+  size_t pagesize = __slibc_heap_pagesize();
+  struct heap_span* evicted = NULL;
+  struct heap_cache* caches;
+  struct heap_span* spans;
+  struct heap_span* span;
+  size_t index;
+  int released = 0;
+  
+  /* Blocks in the calling thread's cache, in the per-CPU
+   * caches, and in the transfer lists, may be all that
+   * keeps spans from being unused. */
+  __slibc_heap_flush_cache();
+  caches = __atomic_load_n(&cpu_caches, __ATOMIC_ACQUIRE);
+  for (index = 0; (caches != NULL) && (index < cpu_count); index++)
+    {
+      HEAP_LOCK(caches[index].lock);
+      cache_flush_all(caches + index);
+      HEAP_UNLOCK(caches[index].lock);
+    }
+  for (index = 0; index < HEAP_CLASS_COUNT; index++)
+    transfer_drain(index);
+  
+  __slibc_heap_decay();
+  HEAP_LOCK(retain_lock);
+  while (retained_bytes > pad)
+    {
+      span = retained_last;
+      retained_unlink(span);
+      span->next = evicted;
+      evicted = span;
+    }
+  HEAP_UNLOCK(retain_lock);
+  
+  for (; evicted != NULL; evicted = span, released = 1)
+    {
+      span = evicted->next;
+      retained_unmap(evicted);
+    }
+  
+  /* The span's header, with the link to the next span,
+   * is kept. The spans are taken from the list meanwhile,
+   * so that no size class uses them while they are purged. */
+  HEAP_LOCK(span_lock);
+  spans = free_spans;
+  free_spans = NULL;
+  HEAP_UNLOCK(span_lock);
+  
+  if (spans == NULL)
+    return released;
+  for (span = spans;; span = span->next)
+    {
+      HEAP_COUNT(purge_calls, 1);
+      if (!madvise((char*)span + pagesize, HEAP_SPAN_SIZE - pagesize, MADV_DONTNEED))
+	released = 1;
+      if (span->next == NULL)
+	break;
+    }
+  
+  HEAP_LOCK(span_lock);
+  span->next = free_spans;
+  free_spans = spans;
+  HEAP_UNLOCK(span_lock);
+  
+  return released;
+}
+
+
+/**
+ * Apply `SLIBC_MALLOC_CONF` at start-up. This is done
+ * here, rather than with `mallopt`, because `mallopt`
+ * is only linked in if the program calls it.
+ */
+__attribute__((__constructor__))
+static void heap_init(void)
+{
+  __slibc_heap_configure();
+}
+
@@ -0,0 +1,1025 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* This file is intended to be included by the implementation
+ * of the malloc-family, and by nothing else. It describes the
+ * heap that `malloc`, `memalign`, `free`, &c. are built on.
+ * 
+ * Memory is obtained from the kernel in chunks that are split
+ * into spans of `HEAP_SPAN_SIZE` bytes. A span is aligned to its
+ * size, and starts with a `struct heap_span` that describes it.
+ * Small allocations are carved from spans dedicated to a size
+ * class, and have no header, their size class is found by
+ * masking the pointer. Large allocations are mapped directly,
+ * but the mapping is aligned in the same way and starts with a
+ * `struct heap_span`, so that lookup is identical. The
+ * mappings of deallocated large allocations are kept for
+ * reuse, until they decay, or too many are kept. */
+#include <stddef.h>
+#include <stdint.h>
+/* TODO #include <sys/mman.h> */
+/* TODO #include <sched.h> */
+/* TODO #include <time.h> */
+/* TODO temporary constants/functions from other headers { */
+#define PROT_READ       1
+#define PROT_WRITE      2
+#define MAP_PRIVATE     0x02
+#define MAP_ANONYMOUS   0x20
+#define MAP_FAILED      ((void*)-1)
+#define MREMAP_MAYMOVE  1
+#define MREMAP_FIXED    2
+#define MADV_DONTNEED   4
+#define MADV_HUGEPAGE   14
+#define _SC_PAGESIZE    30
+#define _SC_NPROCESSORS_CONF  83
+#define CLOCK_MONOTONIC  1
+struct timespec { long tv_sec; long tv_nsec; };
+void* mmap(void*, size_t, int, int, int, long);
+int munmap(void*, size_t);
+int madvise(void*, size_t, int);
+long sysconf(int);
+void* mremap(void*, size_t, size_t, int, ...);
+int sched_getcpu(void);
+int clock_gettime(int, struct timespec*);
+/* } */
+
+
+
+/**
+ * The size, and alignment, of a span.
+ */
+#define HEAP_SPAN_SIZE  ((size_t)1 << 18)
+
+/**
+ * The number of spans that are mapped at the same time
+ * when the heap needs to grow.
+ */
+#define HEAP_CHUNK_SPANS  16
+
+/**
+ * The number of size classes. Must not exceed 64,
+ * `__slibc_heap_free_batch` keeps a bit mask of
+ * the size classes it has touched.
+ */
+#define HEAP_CLASS_COUNT  36
+
+/**
+ * The largest allocation size served from a size class,
+ * larger allocations are mapped directly. This is also
+ * the default value of `__slibc_heap_mmap_threshold`.
+ */
+#define HEAP_SMALL_MAX  ((size_t)16384)
+
+/**
+ * The smallest granularity of the size classes,
+ * and the alignment of every block.
+ */
+#define HEAP_QUANTUM  ((size_t)16)
+
+/**
+ * The largest natural alignment a size class is given.
+ */
+#define HEAP_CLASS_ALIGN_MAX  ((size_t)4096)
+
+/**
+ * The default value of `__slibc_heap_cache_bytes`.
+ */
+#define HEAP_CACHE_BYTES  ((size_t)32768)
+
+/**
+ * The least number of blocks that are moved at a
+ * time between a size class and a thread's cache.
+ */
+#define HEAP_CACHE_BATCH_MIN  ((size_t)4)
+
+/**
+ * The greatest number of blocks that are moved at
+ * a time between a size class and a thread's cache.
+ */
+#define HEAP_CACHE_BATCH_MAX  ((size_t)64)
+
+/**
+ * The number of batches of blocks that may wait in the
+ * transfer list of a size class, before blocks are
+ * returned to their spans instead.
+ */
+#define HEAP_TRANSFER_MAX  ((size_t)16)
+
+/**
+ * The size, and alignment, of a transparent huge page.
+ */
+#define HEAP_HUGE_PAGE_SIZE  ((size_t)1 << 21)
+
+/**
+ * The default value of `__slibc_heap_huge_threshold`.
+ */
+#define HEAP_HUGE_THRESHOLD  HEAP_HUGE_PAGE_SIZE
+
+/**
+ * The maximum number of mappings of deallocated
+ * large allocations that are kept for reuse.
+ */
+#define HEAP_RETAIN_COUNT  64
+
+/**
+ * The maximum number of bytes in mappings of deallocated
+ * large allocations that are kept for reuse.
+ */
+#define HEAP_RETAIN_BYTES  ((size_t)64 << 20)
+
+/**
+ * The size of the largest mapping of a deallocated
+ * large allocation that is kept for reuse.
+ */
+#define HEAP_RETAIN_MAX  ((size_t)16 << 20)
+
+/**
+ * The default value of `__slibc_heap_retain_decay`.
+ */
+#define HEAP_RETAIN_DECAY  10000
+
+/**
+ * The distance between the start of the span, and the
+ * returned pointer, for a large allocation without alignment.
+ */
+#define HEAP_LARGE_OFFSET  ((sizeof(struct heap_span) + 63) & ~(size_t)63)
+
+
+/**
+ * Get the span a pointer returned by the heap belongs to.
+ * 
+ * Pointers returned by the heap are never at the
+ * beginning of a span, but can be at the end of one,
+ * which is why one is subtracted before masking.
+ * 
+ * @param   p:void*                  The pointer.
+ * @return  :struct heap_span*       The span containing the pointer.
+ */
+#define HEAP_SPAN(p)  \
+  ((struct heap_span*)(((size_t)(p) - 1) & ~(size_t)(HEAP_SPAN_SIZE - 1)))
+
+
+/**
+ * Increase a counter in `__slibc_heap_stats`.
+ * 
+ * @param  field:identifier  The counter.
+ * @param  n:size_t          The value to add to the counter.
+ */
+#define HEAP_COUNT(field, n)  \
+  ((void)__atomic_add_fetch(&(__slibc_heap_stats.field), (size_t)(n), __ATOMIC_RELAXED))
+
+
+/**
+ * Let the heap profiler sample a new allocation,
+ * if the profiler is active.
+ * 
+ * @param   ptr:void*    The allocation, may be `NULL`.
+ * @param   size:size_t  The size of the allocation.
+ * @return  :void*       `ptr`.
+ */
+#define HEAP_SAMPLE(ptr, size)						\
+  ((__builtin_expect(__slibc_heapprof_interval != 0, 0) && ((ptr) != NULL))	\
+   ? __slibc_heapprof_sample(ptr, size) : (void*)(ptr))
+
+
+/**
+ * Acquire a heap lock.
+ * 
+ * @param  l:heap_lock_t  The lock.
+ */
+#define HEAP_LOCK(l)							\
+  do									\
+    while (__atomic_test_and_set(&(l), __ATOMIC_ACQUIRE))		\
+      while (__atomic_load_n(&(l), __ATOMIC_RELAXED))			\
+	;								\
+  while (0)
+
+/**
+ * Release a heap lock.
+ * 
+ * @param  l:heap_lock_t  The lock.
+ */
+#define HEAP_UNLOCK(l)  __atomic_clear(&(l), __ATOMIC_RELEASE)
+
+
+
+/**
+ * Spinlock used to protect the shared parts of the heap.
+ * Critical sections are only a few instructions long,
+ * and never make system calls, except for when spans
+ * are mapped.
+ */
+typedef char heap_lock_t;
+
+
+/**
+ * Header of a span.
+ */
+struct heap_span
+{
+  /**
+   * The size class plus one, zero if the span
+   * is a large allocation.
+   */
+  size_t class;
+  
+  /**
+   * The size of each block in the span.
+   * For large allocations, the size of the mapping.
+   */
+  size_t block_size;
+  
+  /**
+   * The first block in the span.
+   * For large allocations, the returned pointer.
+   */
+  char* data;
+  
+  /**
+   * The number of blocks the span can hold.
+   */
+  size_t count;
+  
+  /**
+   * The number of blocks that have been carved
+   * from the span, blocks are carved in order.
+   */
+  size_t carved;
+  
+  /**
+   * The number of blocks that are in use.
+   */
+  size_t used;
+  
+  /**
+   * Linked list of free, previously carved, blocks.
+   */
+  void* free;
+  
+  /**
+   * The next span in the list the span is in.
+   * For large allocations, the next mapping
+   * that is kept for reuse.
+   */
+  struct heap_span* next;
+  
+  /**
+   * The previous span in the list the span is in.
+   * For large allocations, the previous mapping
+   * that is kept for reuse.
+   */
+  struct heap_span* prev;
+  
+  /**
+   * The size of each allocation in the span, as requested
+   * by the user, indexed by block. For large allocations,
+   * `sizes` is `NULL`, and `size` is used instead.
+   */
+  uint16_t* sizes;
+  
+  /**
+   * The size of a large allocation, as requested by the user.
+   */
+  size_t size;
+  
+  /**
+   * Whether the large allocation has been advised
+   * to be backed by transparent huge pages.
+   */
+  int huge;
+  
+  /**
+   * For large allocations, the offset into the mapping
+   * from where all bytes are known to be zero, except
+   * for those in the allocation, that the user may have
+   * written to since the mapping was created or resized.
+   */
+  size_t zero;
+  
+  /**
+   * For mappings of deallocated large allocations that are
+   * kept for reuse, the time, in milliseconds on the
+   * monotonic clock, when the mapping was kept.
+   */
+  size_t retired;
+};
+
+
+/**
+ * A size class.
+ */
+struct heap_class
+{
+  /**
+   * Lock for the class, and its spans.
+   */
+  heap_lock_t lock;
+  
+  /**
+   * The size of each block.
+   */
+  size_t size;
+  
+  /**
+   * The natural alignment of each block.
+   */
+  size_t alignment;
+  
+  /**
+   * The number of blocks per span.
+   */
+  size_t count;
+  
+  /**
+   * The offset of the first block in each span.
+   */
+  size_t offset;
+  
+  /**
+   * `ceil((1 << 32) / size)`, used to find
+   * the index of a block without division.
+   */
+  uint64_t reciprocal;
+  
+  /**
+   * The number of blocks that are moved at a time
+   * between the class and a thread's cache. A thread
+   * caches at most twice this number of blocks.
+   */
+  size_t batch;
+  
+  /**
+   * Spans with at least one free block,
+   * either carved or uncarved.
+   */
+  struct heap_span* partial;
+  
+  /**
+   * The number of spans used by the class.
+   */
+  size_t spans;
+  
+  /**
+   * The number of blocks that have been taken
+   * from the spans, including those that are
+   * in the threads' caches.
+   */
+  size_t used;
+  
+  /**
+   * The number of blocks in the threads' caches, and in
+   * `transfer`, as of when each thread last moved blocks
+   * to or from the class. It is therefore only approximate,
+   * the error is at most `2 * batch` blocks per thread.
+   */
+  size_t cached;
+  
+  /**
+   * Batches of `batch` blocks that threads have moved out
+   * of their caches, for other threads to take into theirs,
+   * without locking the class. The blocks in a batch are
+   * linked through their first word, and the first block
+   * in a batch links to the next batch through its second
+   * word. This list is modified with atomic operations
+   * only, and is not protected by `lock`.
+   */
+  void* transfer;
+  
+  /**
+   * The number of batches in `transfer`, approximately.
+   */
+  size_t transfers;
+};
+
+
+
+/**
+ * Statistics about the heap. The counters are updated
+ * with relaxed atomic operations, and only on paths
+ * that already make system calls, or copy memory.
+ */
+struct heap_stats
+{
+  /**
+   * The number of bytes mapped for spans.
+   */
+  size_t small_mapped;
+  
+  /**
+   * The number of bytes in spans that are used by
+   * memory that is not managed by the size classes,
+   * see `__slibc_heap_span_get`.
+   */
+  size_t small_lent;
+  
+  /**
+   * The number of large allocations.
+   */
+  size_t large_count;
+  
+  /**
+   * The number of bytes mapped for large allocations.
+   */
+  size_t large_mapped;
+  
+  /**
+   * The number of bytes requested by the
+   * user for large allocations.
+   */
+  size_t large_in_use;
+  
+  /**
+   * The number of bytes in mappings of deallocated
+   * large allocations that are kept for reuse.
+   */
+  size_t large_retained;
+  
+  /**
+   * The number of calls to `mmap`.
+   */
+  size_t mmap_calls;
+  
+  /**
+   * The number of calls to `munmap`.
+   */
+  size_t munmap_calls;
+  
+  /**
+   * The number of calls to `mremap`.
+   */
+  size_t mremap_calls;
+  
+  /**
+   * The number of calls to `madvise` that
+   * returned pages to the kernel.
+   */
+  size_t purge_calls;
+  
+  /**
+   * The number of reallocations that
+   * were made without moving the allocation.
+   */
+  size_t realloc_in_place;
+  
+  /**
+   * The number of reallocations that moved
+   * the allocation by remapping its pages.
+   */
+  size_t realloc_moved;
+  
+  /**
+   * The number of reallocations that copied
+   * the allocation to a new allocation.
+   */
+  size_t realloc_copied;
+  
+  /**
+   * The number of calls to `extalloc`
+   * that resized the allocation in place.
+   */
+  size_t extalloc_in_place;
+  
+  /**
+   * The number of calls to `extalloc` that could
+   * not resize the allocation in place.
+   */
+  size_t extalloc_failed;
+};
+
+
+
+/**
+ * A cache of free blocks of a size class.
+ */
+struct heap_bin
+{
+  /**
+   * Linked list of the blocks.
+   */
+  void* head;
+  
+  /**
+   * The number of blocks in the list.
+   */
+  size_t count;
+  
+  /**
+   * The value `count` had when the cache last
+   * moved blocks to or from the size class.
+   */
+  size_t reported;
+};
+
+
+/**
+ * A thread's, or a CPU's, cache of free blocks.
+ * 
+ * Allocations and deallocations are served from, and
+ * to, a thread's cache without taking any lock. Blocks
+ * are moved between the cache and the size classes in
+ * batches, so the lock of a size class is taken
+ * once per batch rather than once per allocation.
+ * 
+ * If per-CPU caches are used, the number of cached
+ * blocks is bounded by the number of CPUs rather than
+ * by the number of threads. A per-CPU cache is locked,
+ * but the lock is only contended if a thread is
+ * preempted or migrated while using it, in which
+ * case the other thread uses its own cache instead.
+ */
+struct heap_cache
+{
+  /**
+   * Lock for the cache, only used for per-CPU caches.
+   */
+  heap_lock_t lock;
+  
+  /**
+   * The cache, per size class.
+   */
+  struct heap_bin bins[HEAP_CLASS_COUNT];
+} __GCC_ONLY(__attribute__((__aligned__(64))));
+
+
+
+/**
+ * The size classes.
+ */
+extern struct heap_class __slibc_heap_classes[HEAP_CLASS_COUNT];
+
+/**
+ * Large allocations whose mappings are at least this
+ * large are aligned to, and backed by, transparent
+ * huge pages. Zero if huge pages shall not be used.
+ */
+extern size_t __slibc_heap_huge_threshold;
+
+/**
+ * Allocations larger than this get a mapping of their
+ * own, rather than a block in a size class. No greater
+ * than `HEAP_SMALL_MAX`, set with
+ * `__slibc_heap_set_mmap_threshold`.
+ */
+extern size_t __slibc_heap_mmap_threshold;
+
+/**
+ * The number of bytes worth of blocks that are moved
+ * at a time between a size class and a thread's cache.
+ * Size classes that are already in use keep the number
+ * of blocks they were given when they were first used.
+ */
+extern size_t __slibc_heap_cache_bytes;
+
+/**
+ * The number of milliseconds a mapping is kept for
+ * reuse before its pages are returned to the kernel.
+ */
+extern size_t __slibc_heap_retain_decay;
+
+/**
+ * Whether spans are carved from the data segment,
+ * rather than from mappings of their own.
+ */
+extern int __slibc_heap_brk;
+
+/**
+ * The number of bytes in large allocations that
+ * are backed by transparent huge pages.
+ */
+extern size_t __slibc_heap_huge_bytes;
+
+/**
+ * `memset`, except calls to it cannot be removed by the compiler.
+ * Defined with `explicit_bzero`.
+ */
+extern void* (*volatile __slibc_explicit_memset)(void*, int, size_t);
+
+/**
+ * Statistics about the heap.
+ */
+extern struct heap_stats __slibc_heap_stats;
+
+/**
+ * The average number of bytes between each allocation
+ * the heap profiler samples, zero if it is inactive.
+ */
+extern size_t __slibc_heapprof_interval;
+
+/**
+ * The number of sampled allocations that
+ * have not been deallocated.
+ */
+extern size_t __slibc_heapprof_live;
+
+
+
+/**
+ * Return the pagesize. If it it cannot be retrieved,
+ * use a fallback value.
+ * 
+ * @return  The pagesize, or a fallback value.
+ */
+size_t __slibc_heap_pagesize(void)
+  __GCC_ONLY(__attribute__((__warn_unused_result__, __const__)));
+
+/**
+ * Create a new allocation, without initialising it.
+ * 
+ * @param   size  The size of the allocation, must not be zero.
+ * @return        The new allocation, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+void* __slibc_heap_alloc(size_t)
+  __GCC_ONLY(__attribute__((__malloc__, __warn_unused_result__)));
+
+/**
+ * Create a new aligned allocation, without initialising it.
+ * 
+ * @param   boundary  The alignment, must be a power of two.
+ * @param   size      The size of the allocation, must not be zero.
+ * @return            The new allocation, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+void* __slibc_heap_alloc_aligned(size_t, size_t)
+  __GCC_ONLY(__attribute__((__malloc__, __warn_unused_result__)));
+
+/**
+ * Create a new aligned allocation, without initialising it,
+ * and without recording its size if it is small. It must be
+ * resized with `__slibc_heap_resize_unsized`, and deallocated
+ * with `__slibc_heap_free_sized`.
+ * 
+ * @param   boundary  The alignment, must be a power of two.
+ * @param   size      The size of the allocation, must not be zero.
+ * @return            The new allocation, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+void* __slibc_heap_alloc_unsized(size_t, size_t)
+  __GCC_ONLY(__attribute__((__malloc__, __warn_unused_result__)));
+
+/**
+ * Create a number of allocations of the same size,
+ * without initialising them.
+ * 
+ * @param   size   The size of each allocation, must not be zero.
+ * @param   count  The number of allocations.
+ * @param   ptrs   Output array for the allocations.
+ * @return         The number of allocations that were created,
+ *                 they are stored at the beginning of `ptrs`.
+ *                 Less than `count` is returned on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+size_t __slibc_heap_alloc_batch(size_t, size_t, void**)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Resize an allocation without moving it.
+ * 
+ * @param   ptr   The allocation, must not be `NULL`.
+ * @param   size  The new size of the allocation, must not be zero.
+ * @return        `ptr` on success, `NULL` with `errno` set to
+ *                zero if the allocation must be moved.
+ * 
+ * @throws  0  The allocation cannot be resized in place.
+ */
+void* __slibc_heap_resize(void*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__)));
+
+/**
+ * Resize an allocation created with `__slibc_heap_alloc_unsized`
+ * without moving it.
+ * 
+ * @param   ptr       The allocation, must not be `NULL`.
+ * @param   boundary  The alignment the allocation was created with.
+ * @param   size      The new size of the allocation, must not be zero.
+ * @return            `ptr` on success, `NULL` with `errno` set to
+ *                    zero if the allocation must be moved.
+ * 
+ * @throws  0  The allocation cannot be resized in place.
+ */
+void* __slibc_heap_resize_unsized(void*, size_t, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__)));
+
+/**
+ * Resize an allocation without copying its content,
+ * by moving its pages if it is a large allocation.
+ * `ptr` becomes invalid if a new pointer is returned.
+ * 
+ * @param   ptr       The allocation, must not be `NULL`.
+ * @param   boundary  The alignment, of the new pointer, if it is moved.
+ * @param   size      The new size of the allocation, must not be zero.
+ * @return            `ptr`, or the new pointer, on success, `NULL` with
+ *                    `errno` set to zero if the content must be copied
+ *                    to a new allocation, `NULL` on error.
+ * 
+ * @throws  0       The allocation cannot be moved without copying.
+ * @throws  EINVAL  `boundary` is not a power of two.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+void* __slibc_heap_move(void*, size_t, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__, __warn_unused_result__)));
+
+/**
+ * Clear a part of an allocation that the user has not
+ * written to yet, without touching memory that is
+ * known to be zero already.
+ * 
+ * @param  ptr     The allocation, must not be `NULL`.
+ * @param  offset  The offset of the part in the allocation.
+ * @param  size    The size of the part.
+ */
+void __slibc_heap_clear(void*, size_t, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Override a part of an allocation with zeroes,
+ * in a way that cannot be removed by the compiler.
+ * 
+ * @param  ptr     The allocation, must not be `NULL`.
+ * @param  offset  The offset of the part in the allocation.
+ * @param  size    The size of the part.
+ */
+void __slibc_heap_wipe(void*, size_t, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Deallocate an allocation.
+ * 
+ * @param  ptr  The allocation, must not be `NULL`.
+ */
+void __slibc_heap_free(void*)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Deallocate an allocation whose size, and alignment,
+ * is known, without reading the header of its span
+ * unless it is a large allocation.
+ * 
+ * @param  ptr       The allocation, must not be `NULL`.
+ * @param  boundary  The alignment the allocation was created
+ *                   with, any value up to `HEAP_QUANTUM` if it
+ *                   was not created with a specific alignment.
+ * @param  size      The size of the allocation.
+ */
+void __slibc_heap_free_sized(void*, size_t, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Deallocate a number of allocations.
+ * 
+ * @param  ptrs   The allocations, `NULL`s are ignored.
+ * @param  count  The number of elements in `ptrs`.
+ */
+void __slibc_heap_free_batch(void**, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Get an unused span, for memory that is not
+ * managed by the size classes.
+ * 
+ * @return  An unused span, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+void* __slibc_heap_span_get(void)
+  __GCC_ONLY(__attribute__((__malloc__, __warn_unused_result__)));
+
+/**
+ * Return a span from `__slibc_heap_span_get`
+ * to the heap.
+ * 
+ * @param  span  The span.
+ */
+void __slibc_heap_span_put(void*)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Return all blocks in the calling thread's
+ * cache to their size classes. This shall be
+ * called when a thread exits.
+ */
+void __slibc_heap_flush_cache(void);
+
+/**
+ * Use per-CPU caches, instead of per-thread caches,
+ * for all threads. This cannot be undone.
+ * 
+ * @param   use  Whether per-CPU caches shall be used.
+ * @return       Zero on success, -1 on error.
+ * 
+ * @throws  ENOMEM  `use` is non-zero, and the process
+ *                  cannot allocate more memory.
+ * @throws  EINVAL  `use` is zero, but per-CPU caches
+ *                  are already used.
+ */
+int __slibc_heap_use_cpu_caches(int);
+
+/**
+ * Set `__slibc_heap_mmap_threshold`.
+ * 
+ * @param   threshold  The new threshold.
+ * @return             Zero on success, -1 on error.
+ * 
+ * @throws  EINVAL  `threshold` is greater than `HEAP_SMALL_MAX`.
+ */
+int __slibc_heap_set_mmap_threshold(size_t);
+
+/**
+ * Return unused memory to the kernel.
+ * 
+ * @param   pad  The number of bytes in mappings of deallocated
+ *               large allocations that may be kept for reuse.
+ * @return       1 if any memory was returned, 0 otherwise.
+ */
+int __slibc_heap_trim(size_t);
+
+/**
+ * Return the pages of the mappings, that have been kept
+ * for reuse for `__slibc_heap_retain_decay` milliseconds,
+ * to the kernel. The heap does this when large allocations
+ * are created and deallocated, and when statistics are read.
+ */
+void __slibc_heap_decay(void);
+
+/**
+ * Set the parameters of the heap listed in
+ * the environment variable `SLIBC_MALLOC_CONF`.
+ */
+void __slibc_heap_configure(void);
+
+
+
+/**
+ * Count a new allocation towards the next sample of the
+ * heap profiler, and sample it if it is its turn.
+ * 
+ * @param   ptr   The allocation, must not be `NULL`.
+ * @param   size  The size of the allocation.
+ * @return        `ptr`.
+ */
+void* __slibc_heapprof_sample(void*, size_t)
+  __GCC_ONLY(__attribute__((__nonnull__, __returns_nonnull__)));
+
+/**
+ * Tell the heap profiler that an allocation has
+ * been moved, so that its sample follows it.
+ * 
+ * @param  old_ptr  The old pointer of the allocation.
+ * @param  new_ptr  The new pointer of the allocation.
+ */
+void __slibc_heapprof_move(void*, void*)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+/**
+ * Tell the heap profiler that an allocation
+ * is about to be deallocated.
+ * 
+ * @param  ptr  The allocation.
+ */
+void __slibc_heapprof_forget(void*)
+  __GCC_ONLY(__attribute__((__nonnull__)));
+
+
+
+/**
+ * Get the size class for an allocation size.
+ * 
+ * @param   size  The allocation size, no greater than `HEAP_SMALL_MAX`.
+ * @return        The index of the size class.
+ */
+__GCC_ONLY(__attribute__((__const__, __warn_unused_result__, __always_inline__)))
+static inline size_t heap_class_of(size_t size)
+{
+  size_t k;
+  if (size <= 128)
+    return size ? (size - 1) / HEAP_QUANTUM : 0;
+  k = (size_t)(sizeof(long int) * 8 - 1) - (size_t)__builtin_clzl((unsigned long int)(size - 1));
+  return 8 + (k - 7) * 4 + ((size - 1) >> (k - 2)) - 4;
+}
+
+
+/**
+ * Get the block size of a size class.
+ * 
+ * @param   index  The index of the size class.
+ * @return         The block size of the size class.
+ */
+__GCC_ONLY(__attribute__((__const__, __warn_unused_result__, __always_inline__)))
+static inline size_t heap_class_size(size_t index)
+{
+  size_t group;
+  if (index < 8)
+    return (index + 1) * HEAP_QUANTUM;
+  group = (index - 8) / 4;
+  return ((size_t)128 << group) + ((index - 8) % 4 + 1) * ((size_t)32 << group);
+}
+
+
+/**
+ * Get the size class for an aligned allocation.
+ * 
+ * The blocks of a size class are naturally aligned to
+ * the largest power of two that divides the block size,
+ * up to `HEAP_CLASS_ALIGN_MAX`. The smallest size class
+ * whose blocks are aligned to `boundary` is used, unless
+ * a smaller size class has room for shifting the pointer
+ * to the alignment.
+ * 
+ * @param   boundary  The alignment, a power of two greater than `HEAP_QUANTUM`.
+ * @param   size      The size of the allocation.
+ * @return            The index of the size class, `HEAP_CLASS_COUNT`
+ *                    if the allocation must be a large allocation.
+ */
+__GCC_ONLY(__attribute__((__const__, __warn_unused_result__, __always_inline__)))
+static inline size_t heap_aligned_class_of(size_t boundary, size_t size)
+{
+  size_t index, shifted, block;
+  
+  if (size > HEAP_SMALL_MAX)
+    return HEAP_CLASS_COUNT;
+  
+  /* Blocks are always aligned to the quantum, so less
+   * than `boundary - 1` bytes are needed for shifting. */
+  if (__builtin_uaddl_overflow(size, boundary - HEAP_QUANTUM, &shifted) || (shifted > HEAP_SMALL_MAX))
+    shifted = HEAP_CLASS_COUNT;
+  else
+    shifted = heap_class_of(shifted);
+  
+  if (boundary <= HEAP_CLASS_ALIGN_MAX)
+    for (index = heap_class_of(size); index < shifted; index++)
+      {
+	block = heap_class_size(index);
+	if ((block & -block) >= boundary)
+	  return index;
+      }
+  return shifted;
+}
+
+
+/**
+ * Get the index of a block in its span.
+ * 
+ * @param   span   The span.
+ * @param   class  The size class of the span.
+ * @param   ptr    Pointer to the block, or into the block.
+ * @return         The index of the block.
+ */
+__GCC_ONLY(__attribute__((__pure__, __nonnull__, __warn_unused_result__)))
+static inline size_t heap_block_index(const struct heap_span* span,
+				      const struct heap_class* class, const void* ptr)
+{
+  uint64_t offset = (uint64_t)((const char*)ptr - span->data);
+  return (size_t)((offset * class->reciprocal) >> 32);
+}
+
+
+/**
+ * Get the user-requested size of an allocation.
+ * 
+ * @param   ptr  The allocation, must not be `NULL`.
+ * @return       The size of the allocation.
+ */
+__GCC_ONLY(__attribute__((__pure__, __nonnull__, __warn_unused_result__, __always_inline__)))
+static inline size_t heap_size_of(const void* ptr)
+{
+  const struct heap_span* span = HEAP_SPAN(ptr);
+  if (span->class == 0)
+    return span->size;
+  return span->sizes[heap_block_index(span, __slibc_heap_classes + span->class - 1, ptr)];
+}
+
+
+/**
+ * Set the user-requested size of an allocation.
+ * 
+ * @param  ptr   The allocation, must not be `NULL`.
+ * @param  size  The new size of the allocation.
+ */
+__GCC_ONLY(__attribute__((__nonnull__, __always_inline__)))
+static inline void heap_set_size(void* ptr, size_t size)
+{
+  struct heap_span* span = HEAP_SPAN(ptr);
+  if (span->class == 0)
+    span->size = size;
+  else
+    span->sizes[heap_block_index(span, __slibc_heap_classes + span->class - 1, ptr)] = (uint16_t)size;
+}
+
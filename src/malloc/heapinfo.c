@@ -0,0 +1,133 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <slibc-alloc.h>
+#include "heap.h"
+
+
+
+/**
+ * Read a counter in `__slibc_heap_stats`.
+ * 
+ * @param   field:identifier  The counter.
+ * @return  :size_t           The value of the counter.
+ */
+#define HEAP_READ(field)  __atomic_load_n(&(__slibc_heap_stats.field), __ATOMIC_RELAXED)
+
+
+
+/**
+ * Get statistics about a size class.
+ * 
+ * @param  index  The index of the size class.
+ * @param  info   Output parameter for the statistics.
+ */
+static void class_info(size_t index, struct heapinfo_class* info)
+{
+  struct heap_class* class = __slibc_heap_classes + index;
+  
+  HEAP_LOCK(class->lock);
+  info->block_size = heap_class_size(index);
+  info->cached     = __atomic_load_n(&(class->cached), __ATOMIC_RELAXED);
+  /* `cached` is approximate, and may exceed `used` for a while. */
+  info->live       = info->cached > class->used ? 0 : class->used - info->cached;
+  info->free       = class->spans * class->count - class->used;
+  info->spans      = class->spans;
+  HEAP_UNLOCK(class->lock);
+}
+
+
+/**
+ * Get statistics about the heap.
+ * 
+ * The statistics are maintained continuously, at
+ * a negligible cost, so this function is cheap,
+ * and can be called at any time, by any thread.
+ * Counters of events are never reset, the rate
+ * of events can be calculated by calling this
+ * function periodically.
+ * 
+ * @etymology  (Heap) (info)rmation.
+ * 
+ * @param  info  Output parameter for the statistics.
+ * 
+ * @since  Always.
+ */
+void heapinfo(struct heapinfo* info)
+{
+  struct heapinfo_class class;
+  size_t index, spans = 0;
+  
+  /* Programs that poll the statistics see the retained
+   * pages decay even if they make no large allocations. */
+  __slibc_heap_decay();
+  
+  info->small_in_use = 0;
+  info->small_cached = 0;
+  for (index = 0; index < HEAP_CLASS_COUNT; index++)
+    {
+      class_info(index, &class);
+      info->small_in_use += class.live * class.block_size;
+      info->small_cached += class.cached * class.block_size;
+      spans += class.spans;
+    }
+  
+  info->small_mapped      = HEAP_READ(small_mapped);
+  info->small_unused      = info->small_mapped - spans * HEAP_SPAN_SIZE - HEAP_READ(small_lent);
+  info->large_count       = HEAP_READ(large_count);
+  info->large_mapped      = HEAP_READ(large_mapped);
+  info->large_in_use      = HEAP_READ(large_in_use);
+  info->large_retained    = HEAP_READ(large_retained);
+  info->huge_mapped       = __atomic_load_n(&__slibc_heap_huge_bytes, __ATOMIC_RELAXED);
+  info->mmap_calls        = HEAP_READ(mmap_calls);
+  info->munmap_calls      = HEAP_READ(munmap_calls);
+  info->mremap_calls      = HEAP_READ(mremap_calls);
+  info->purge_calls       = HEAP_READ(purge_calls);
+  info->realloc_in_place  = HEAP_READ(realloc_in_place);
+  info->realloc_moved     = HEAP_READ(realloc_moved);
+  info->realloc_copied    = HEAP_READ(realloc_copied);
+  info->extalloc_in_place = HEAP_READ(extalloc_in_place);
+  info->extalloc_failed   = HEAP_READ(extalloc_failed);
+  info->class_count       = HEAP_CLASS_COUNT;
+  
+  info->mapped = info->small_mapped + info->large_mapped + info->large_retained;
+  info->in_use = info->small_in_use + info->large_in_use;
+}
+
+
+/**
+ * Get statistics about the size classes of the heap.
+ * 
+ * @etymology  (Heap) (info)rmation: size (classes).
+ * 
+ * @param   classes  Output parameter for the statistics, ordered
+ *                   by block size. May be `NULL` if `count` is zero.
+ * @param   count    The number of elements in `classes`.
+ * @return           The number of size classes, this may be
+ *                   more than `count`, in which case only the
+ *                   `count` first classes are stored.
+ * 
+ * @since  Always.
+ */
+size_t heapinfo_classes(struct heapinfo_class* classes, size_t count)
+{
+  size_t index;
+  for (index = 0; (index < count) && (index < HEAP_CLASS_COUNT); index++)
+    class_info(index, classes + index);
+  return HEAP_CLASS_COUNT;
+}
+
@@ -0,0 +1,575 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <slibc-alloc.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include "heap.h"
+
+
+
+/* TODO temporary constants/functions from other headers { */
+#define O_RDONLY  0
+#define O_CLOEXEC  02000000
+void (*signal(int, void (*)(int)))(int);
+int open(const char*, int, ...);
+ssize_t read(int, void*, size_t);
+int close(int);
+/* } */
+
+
+
+/**
+ * The greatest number of frames recorded per sample.
+ */
+#define MAX_DEPTH  32
+
+/**
+ * The number of buckets in the table of samples.
+ */
+#define BUCKETS  1024
+
+/**
+ * The greatest distance between two adjacent stack
+ * frames, anything further away is assumed not to
+ * be a frame.
+ */
+#define MAX_FRAME_SIZE  ((size_t)1 << 20)
+
+/**
+ * Get the bucket in the table of samples
+ * that a pointer belongs to.
+ * 
+ * @param   ptr:void*  The pointer.
+ * @return  :size_t    The index of the bucket.
+ */
+#define BUCKET(ptr)  ((((size_t)(ptr) >> 4) * (size_t)0x9E3779B97F4A7C15ULL) >> (sizeof(size_t) * 8 - 10))
+
+
+
+/**
+ * A sampled allocation.
+ */
+struct sample
+{
+  /**
+   * The next sample in the same bucket.
+   */
+  struct sample* next;
+  
+  /**
+   * The allocation.
+   */
+  void* ptr;
+  
+  /**
+   * The estimated number of bytes allocated at
+   * the same call stack that this sample represents.
+   */
+  size_t weight;
+  
+  /**
+   * The number of frames in `stack`.
+   */
+  size_t depth;
+  
+  /**
+   * The return addresses of the call stack,
+   * innermost first.
+   */
+  void* stack[MAX_DEPTH];
+};
+
+
+
+/**
+ * The average number of bytes between each allocation
+ * the heap profiler samples, zero if it is inactive.
+ */
+size_t __slibc_heapprof_interval = 0;
+
+/**
+ * The number of sampled allocations that
+ * have not been deallocated.
+ */
+size_t __slibc_heapprof_live = 0;
+
+/**
+ * The sampled allocations, by address.
+ */
+static struct sample* samples[BUCKETS];
+
+/**
+ * Lock for `samples`.
+ */
+static heap_lock_t samples_lock;
+
+/**
+ * The number of bytes the calling thread shall
+ * allocate before its next allocation is sampled,
+ * zero if it has not been drawn yet.
+ */
+static __thread size_t countdown = 0;
+
+/**
+ * The state of the calling thread's random number
+ * generator, used to randomise the sample intervals.
+ */
+static __thread size_t random_state = 0;
+
+/**
+ * Whether the calling thread is inside the profiler,
+ * in which case its allocations are not sampled.
+ */
+static __thread int busy = 0;
+
+/**
+ * The lowest address of the mapping that contains
+ * the calling thread's stack, as found on its first
+ * sample. Frame pointers outside the mapping are not
+ * followed, as they cannot be frames.
+ */
+static __thread size_t stack_low = 0;
+
+/**
+ * The address just past the mapping that
+ * contains the calling thread's stack.
+ */
+static __thread size_t stack_high = 0;
+
+/**
+ * The file the profile is written to at exit,
+ * and on `dump_signal`, `-1` if none.
+ */
+static int dump_fd = -1;
+
+
+
+/**
+ * Get the number of bytes until the next sample.
+ * The intervals are randomised so that allocation
+ * patterns that repeat with the same period as the
+ * interval do not skew the profile.
+ * 
+ * @param   interval  The average interval.
+ * @return            The next interval.
+ */
+static size_t next_interval(size_t interval)
+{
+  size_t x = random_state;
+  if (x == 0)
+    x = (size_t)&x | 1;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  random_state = x;
+  return interval / 2 + x % (interval + 1);
+}
+
+
+/**
+ * Find the mapping that contains an address, and store
+ * its bounds in `stack_low` and `stack_high`. Nothing
+ * is allocated, and `errno` is left unchanged.
+ * 
+ * @param   addr  The address, in the calling thread's stack.
+ * @return        Zero on success, -1 if the mapping cannot be found.
+ */
+static int find_stack(size_t addr)
+{
+  char buf[512];
+  size_t start = 0, end = 0;
+  int saved_errno = errno;
+  int fd, field = 0, digit;
+  ssize_t got, i;
+  
+  fd = open("/proc/self/maps", O_RDONLY | O_CLOEXEC);
+  if (fd < 0)
+    return errno = saved_errno, -1;
+  
+  /* Each line starts with the range of the mapping,
+   * as two hexadecimal numbers separated by a hyphen. */
+  while ((got = read(fd, buf, sizeof(buf))) > 0)
+    for (i = 0; i < got; i++)
+      {
+	if (buf[i] == '\n')
+	  {
+	    start = end = 0, field = 0;
+	    continue;
+	  }
+	if (field == 2)
+	  continue;
+	if (('0' <= buf[i]) && (buf[i] <= '9'))
+	  digit = buf[i] - '0';
+	else if (('a' <= buf[i]) && (buf[i] <= 'f'))
+	  digit = buf[i] - 'a' + 10;
+	else if ((field == 0) && (buf[i] == '-'))
+	  {
+	    field = 1;
+	    continue;
+	  }
+	else
+	  {
+	    field = 2;
+	    if ((start <= addr) && (addr < end))
+	      {
+		stack_low = start, stack_high = end;
+		close(fd);
+		return errno = saved_errno, 0;
+	      }
+	    continue;
+	  }
+	if (field == 0)
+	  start = start * 16 + (size_t)digit;
+	else
+	  end = end * 16 + (size_t)digit;
+      }
+  
+  close(fd);
+  return errno = saved_errno, -1;
+}
+
+
+/**
+ * Record the call stack of the caller by walking the
+ * frame pointers. Frames that are not compiled with
+ * frame pointers are skipped, or end the walk. The
+ * walk never leaves the mapping of the thread's stack,
+ * so a register that a function without a frame pointer
+ * uses for other data is never dereferenced outside it.
+ * If the mapping cannot be found, only the caller is
+ * recorded.
+ * 
+ * @param   stack  Output parameter for the return addresses.
+ * @return         The number of return addresses stored.
+ */
+__attribute__((__noinline__))
+static size_t backtrace(void** stack)
+{
+  void** frame = __builtin_frame_address(0);
+  void** next;
+  size_t n = 0;
+  
+  /* The thread may have switched stacks since its first sample. */
+  if (((size_t)frame < stack_low) || ((size_t)frame >= stack_high))
+    if (find_stack((size_t)frame))
+      return *stack = __builtin_return_address(0), 1;
+  
+  while ((n < MAX_DEPTH) && ((size_t)frame >= stack_low) &&
+	 ((size_t)(frame + 2) <= stack_high))
+    {
+      if (frame[1] == NULL)
+	break;
+      stack[n++] = frame[1];
+      next = frame[0];
+      if ((next <= frame) || ((size_t)((char*)next - (char*)frame) > MAX_FRAME_SIZE))
+	break;
+      if ((size_t)next & (sizeof(void*) - 1))
+	break;
+      frame = next;
+    }
+  
+  return n;
+}
+
+
+/**
+ * Count a new allocation towards the next sample of the
+ * heap profiler, and sample it if it is its turn.
+ * 
+ * @param   ptr   The allocation, must not be `NULL`.
+ * @param   size  The size of the allocation.
+ * @return        `ptr`.
+ */
+void* __slibc_heapprof_sample(void* ptr, size_t size)
+{
+  size_t interval = __slibc_heapprof_interval;
+  struct sample* sample;
+  size_t bucket;
+  
+  if (busy || (interval == 0))
+    return ptr;
+  if (countdown == 0)
+    countdown = next_interval(interval);
+  if (countdown > size)
+    return countdown -= size, ptr;
+  countdown = next_interval(interval);
+  
+  busy = 1;
+  sample = __slibc_heap_alloc(sizeof(struct sample));
+  busy = 0;
+  if (sample == NULL)
+    return ptr;
+  
+  /* A sample represents all bytes allocated since the previous
+   * sample, on average. The first frame is in this function. */
+  sample->ptr = ptr;
+  sample->weight = size > interval ? size : interval;
+  sample->depth = backtrace(sample->stack);
+  
+  bucket = BUCKET(ptr);
+  HEAP_LOCK(samples_lock);
+  sample->next = samples[bucket];
+  samples[bucket] = sample;
+  __atomic_add_fetch(&__slibc_heapprof_live, 1, __ATOMIC_RELAXED);
+  HEAP_UNLOCK(samples_lock);
+  
+  return ptr;
+}
+
+
+/**
+ * Remove the sample of an allocation from the table.
+ * `samples_lock` must be held.
+ * 
+ * @param   ptr  The allocation.
+ * @return       The sample, `NULL` if the allocation is not sampled.
+ */
+static struct sample* unlink_sample(void* ptr)
+{
+  struct sample** p;
+  struct sample* sample;
+  
+  for (p = samples + BUCKET(ptr); *p != NULL; p = &((*p)->next))
+    if ((*p)->ptr == ptr)
+      {
+	sample = *p;
+	*p = sample->next;
+	return sample;
+      }
+  
+  return NULL;
+}
+
+
+/**
+ * Tell the heap profiler that an allocation has
+ * been moved, so that its sample follows it.
+ * 
+ * @param  old_ptr  The old pointer of the allocation.
+ * @param  new_ptr  The new pointer of the allocation.
+ */
+void __slibc_heapprof_move(void* old_ptr, void* new_ptr)
+{
+  struct sample* sample;
+  size_t bucket = BUCKET(new_ptr);
+  
+  HEAP_LOCK(samples_lock);
+  sample = unlink_sample(old_ptr);
+  if (sample != NULL)
+    {
+      sample->ptr = new_ptr;
+      sample->next = samples[bucket];
+      samples[bucket] = sample;
+    }
+  HEAP_UNLOCK(samples_lock);
+}
+
+
+/**
+ * Tell the heap profiler that an allocation
+ * is about to be deallocated.
+ * 
+ * @param  ptr  The allocation.
+ */
+void __slibc_heapprof_forget(void* ptr)
+{
+  struct sample* sample;
+  
+  if (busy)
+    return;
+  
+  HEAP_LOCK(samples_lock);
+  sample = unlink_sample(ptr);
+  if (sample != NULL)
+    __atomic_sub_fetch(&__slibc_heapprof_live, 1, __ATOMIC_RELAXED);
+  HEAP_UNLOCK(samples_lock);
+  
+  if (sample != NULL)
+    {
+      busy = 1;
+      __slibc_heap_free(sample);
+      busy = 0;
+    }
+}
+
+
+/**
+ * Append a number to a buffer.
+ * 
+ * @param   buf    The end of the text in the buffer.
+ * @param   value  The number.
+ * @param   base   The base, 10 or 16.
+ * @return         The new end of the text in the buffer.
+ */
+static char* print_number(char* buf, size_t value, size_t base)
+{
+  char digits[sizeof(size_t) * 3];
+  size_t n = 0;
+  do
+    digits[n++] = "0123456789abcdef"[value % base];
+  while (value /= base);
+  while (n)
+    *buf++ = digits[--n];
+  return buf;
+}
+
+
+/**
+ * Start, stop, or change the sampling interval of the
+ * heap profiler. When the profiler is active, it samples
+ * one allocation, on average, each time `interval` bytes
+ * have been allocated, and records its call stack.
+ * 
+ * The call stack is found by walking the frame pointers,
+ * so the program should be compiled with
+ * `-fno-omit-frame-pointer`.
+ * 
+ * @etymology  (Heap) (prof)iler.
+ * 
+ * @param  interval  The average number of bytes between each
+ *                   sample, zero to stop sampling. Allocations
+ *                   that have already been sampled remain in
+ *                   the profile until they are deallocated.
+ * 
+ * @since  Always.
+ */
+void heapprof(size_t interval)
+{
+  __atomic_store_n(&__slibc_heapprof_interval, interval, __ATOMIC_RELAXED);
+}
+
+
+/**
+ * Write the profile of the heap profiler to a file.
+ * 
+ * The profile lists the call stacks of the sampled
+ * allocations that have not been deallocated, in
+ * the folded stack format, one per line, as the
+ * return addresses, in hexadecimal, separated by
+ * semicolons, outermost first, followed by a space
+ * and the estimated number of bytes allocated at the
+ * call stack. Identical call stacks are not merged.
+ * 
+ * This function does not allocate memory, and can
+ * be called from a signal handler.
+ * 
+ * @etymology  (Heap) (prof)iler: (dump) profile.
+ * 
+ * @param   fd  The file descriptor to write to.
+ * @return      Zero on success, -1 on error.
+ * 
+ * @throws  EAGAIN  The profile is being updated by the calling
+ *                  thread, which has been interrupted.
+ * @throws          Any error specified for write(3), except `EINTR`.
+ * 
+ * @since  Always.
+ */
+int heapprof_dump(int fd)
+{
+  char line[MAX_DEPTH * (sizeof(void*) * 2 + 3) + sizeof(size_t) * 3 + 2];
+  struct sample* sample;
+  size_t bucket, i;
+  char* p;
+  int saved_errno;
+  
+  /* Do not deadlock if a signal handler is
+   * invoked while the lock is held. */
+  if (__atomic_test_and_set(&samples_lock, __ATOMIC_ACQUIRE))
+    return errno = EAGAIN, -1;
+  
+  for (bucket = 0; bucket < BUCKETS; bucket++)
+    for (sample = samples[bucket]; sample != NULL; sample = sample->next)
+      {
+	p = line;
+	for (i = sample->depth; i--;)
+	  {
+	    *p++ = '0', *p++ = 'x';
+	    p = print_number(p, (size_t)(sample->stack[i]), 16);
+	    *p++ = i ? ';' : ' ';
+	  }
+	if (sample->depth == 0)
+	  *p++ = '?', *p++ = ' ';
+	p = print_number(p, sample->weight, 10);
+	*p++ = '\n';
+	if (writen(fd, line, (size_t)(p - line)) < 0)
+	  {
+	    saved_errno = errno;
+	    HEAP_UNLOCK(samples_lock);
+	    return errno = saved_errno, -1;
+	  }
+      }
+  
+  HEAP_UNLOCK(samples_lock);
+  return 0;
+}
+
+
+/**
+ * Write the profile to `dump_fd`.
+ */
+static void dump_at_exit(void)
+{
+  heapprof_dump(dump_fd);
+}
+
+
+/**
+ * Write the profile to `dump_fd`.
+ * 
+ * @param  signo  The received signal.
+ */
+static void dump_on_signal(int signo)
+{
+  int saved_errno = errno;
+  heapprof_dump(dump_fd);
+  errno = saved_errno;
+  (void) signo;
+}
+
+
+/**
+ * Start the heap profiler if `SLIBC_HEAPPROF` is set
+ * to the sampling interval. The profile is written,
+ * at exit, and whenever the signal whose number is
+ * in `SLIBC_HEAPPROF_SIGNAL` is received, to the
+ * file `SLIBC_HEAPPROF_FILE`, or to standard error
+ * if it is not set.
+ */
+__attribute__((__constructor__))
+static void heapprof_init(void)
+{
+  const char* interval = getenv("SLIBC_HEAPPROF");
+  const char* path = getenv("SLIBC_HEAPPROF_FILE");
+  const char* signo = getenv("SLIBC_HEAPPROF_SIGNAL");
+  
+  if ((interval == NULL) || (atol(interval) <= 0))
+    return;
+  
+  dump_fd = (path != NULL) ? creat(path, 0644) : STDERR_FILENO;
+  if (dump_fd >= 0)
+    {
+      atexit(dump_at_exit);
+      if ((signo != NULL) && (atoi(signo) > 0))
+	signal(atoi(signo), dump_on_signal);
+    }
+  
+  heapprof((size_t)atol(interval));
+}
+
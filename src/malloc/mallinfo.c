@@ -0,0 +1,94 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <slibc-alloc.h>
+#include "heap.h"
+
+
+# pragma GCC diagnostic ignored "-Waggregate-return"
+
+
+
+/**
+ * Get statistics about the memory allocator.
+ * 
+ * Values that do not fit in an `int` are truncated,
+ * use `mallinfo2` instead, or `heapinfo` for more
+ * detailed statistics.
+ * 
+ * This is a SVID extension.
+ * 
+ * @etymology  (`malloc`)-subsystem: (info)rmation.
+ * 
+ * @return  The statistics.
+ * 
+ * @since  Always.
+ */
+struct mallinfo mallinfo(void)
+{
+  struct mallinfo2 info = mallinfo2();
+  struct mallinfo r;
+  r.arena    = (int)(info.arena);
+  r.ordblks  = (int)(info.ordblks);
+  r.smblks   = (int)(info.smblks);
+  r.hblks    = (int)(info.hblks);
+  r.hblkhd   = (int)(info.hblkhd);
+  r.usmblks  = (int)(info.usmblks);
+  r.fsmblks  = (int)(info.fsmblks);
+  r.uordblks = (int)(info.uordblks);
+  r.fordblks = (int)(info.fordblks);
+  r.keepcost = (int)(info.keepcost);
+  return r;
+}
+
+
+/**
+ * Get statistics about the memory allocator.
+ * 
+ * This is a GNU extension.
+ * 
+ * @etymology  (`malloc`)-subsystem: (info)rmation, version (2).
+ * 
+ * @return  The statistics.
+ * 
+ * @since  Always.
+ */
+struct mallinfo2 mallinfo2(void)
+{
+  struct mallinfo2 r;
+  struct heapinfo info;
+  struct heapinfo_class classes[HEAP_CLASS_COUNT];
+  size_t i;
+  
+  heapinfo(&info);
+  heapinfo_classes(classes, HEAP_CLASS_COUNT);
+  for (r.ordblks = 0, i = 0; i < HEAP_CLASS_COUNT; i++)
+    r.ordblks += classes[i].free + classes[i].cached;
+  
+  r.arena    = info.small_mapped;
+  r.smblks   = 0;
+  r.hblks    = info.large_count;
+  r.hblkhd   = info.large_mapped;
+  r.usmblks  = 0;
+  r.fsmblks  = info.small_cached;
+  r.uordblks = info.small_in_use;
+  r.fordblks = info.small_mapped - info.small_in_use;
+  r.keepcost = info.small_unused + info.large_retained;
+  return r;
+}
+
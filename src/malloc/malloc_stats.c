@@ -0,0 +1,81 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <slibc-alloc.h>
+#include <stdio.h>
+#include "heap.h"
+
+
+
+/**
+ * Print statistics about the memory allocator,
+ * including statistics for each size class,
+ * to `stderr`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @etymology  (`malloc`)-subsystem: print (stat)istic(s).
+ * 
+ * @since  Always.
+ */
+void malloc_stats(void)
+{
+  struct heapinfo info;
+  struct heapinfo_class classes[HEAP_CLASS_COUNT];
+  size_t i;
+  
+  heapinfo(&info);
+  heapinfo_classes(classes, HEAP_CLASS_COUNT);
+  
+  fprintf(stderr,
+	  "mapped bytes        = %10zu\n"
+	  "in use bytes        = %10zu\n"
+	  "small mapped bytes  = %10zu\n"
+	  "small in use bytes  = %10zu\n"
+	  "small cached bytes  = %10zu\n"
+	  "small unused bytes  = %10zu\n"
+	  "large allocations   = %10zu\n"
+	  "large mapped bytes  = %10zu\n"
+	  "large in use bytes  = %10zu\n"
+	  "retained bytes      = %10zu\n"
+	  "huge page bytes     = %10zu\n"
+	  "mmap calls          = %10zu\n"
+	  "munmap calls        = %10zu\n"
+	  "mremap calls        = %10zu\n"
+	  "purge calls         = %10zu\n"
+	  "realloc in place    = %10zu\n"
+	  "realloc moved       = %10zu\n"
+	  "realloc copied      = %10zu\n"
+	  "extalloc in place   = %10zu\n"
+	  "extalloc failed     = %10zu\n"
+	  "\n"
+	  "block size       live     cached       free      spans\n",
+	  info.mapped, info.in_use,
+	  info.small_mapped, info.small_in_use, info.small_cached, info.small_unused,
+	  info.large_count, info.large_mapped, info.large_in_use, info.large_retained,
+	  info.huge_mapped, info.mmap_calls, info.munmap_calls, info.mremap_calls, info.purge_calls,
+	  info.realloc_in_place, info.realloc_moved, info.realloc_copied,
+	  info.extalloc_in_place, info.extalloc_failed);
+  
+  for (i = 0; i < HEAP_CLASS_COUNT; i++)
+    if (classes[i].spans)
+      fprintf(stderr, "%10zu %10zu %10zu %10zu %10zu\n",
+	      classes[i].block_size, classes[i].live, classes[i].cached,
+	      classes[i].free, classes[i].spans);
+}
+
@@ -0,0 +1,50 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include "heap.h"
+
+
+
+/**
+ * Return unused memory to the kernel.
+ * 
+ * Mappings of deallocated large allocations are
+ * kept so that they can be reused without making
+ * system calls or taking page faults. Their pages
+ * are returned to the kernel when they have not
+ * been reused for a while, and the mappings are
+ * unmapped when too many are kept. This function
+ * unmaps them immediately, and returns the pages
+ * of the unused parts of the heap to the kernel.
+ * 
+ * This is a GNU extension.
+ * 
+ * @etymology  (`malloc`)-subsystem: (trim) the heap.
+ * 
+ * @param   pad  The number of bytes in mappings of deallocated
+ *               large allocations that may be kept.
+ * @return       1 if any memory was returned to the kernel,
+ *               0 otherwise.
+ * 
+ * @since  Always.
+ */
+int malloc_trim(size_t pad)
+{
+  return __slibc_heap_trim(pad);
+}
+
@@ -0,0 +1,159 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "heap.h"
+
+
+
+/**
+ * The names of the parameters that can be set
+ * in the environment variable `SLIBC_MALLOC_CONF`.
+ */
+static const struct
+{
+  const char* name;
+  int param;
+} tunables[] =
+  {
+    { "mmap_threshold", M_MMAP_THRESHOLD },
+    { "cache_size",     M_CACHE_SIZE     },
+    { "purge_decay",    M_PURGE_DECAY    },
+    { "huge_threshold", M_HUGE_THRESHOLD },
+    { "cpu_caches",     M_CPU_CACHES     },
+    { "brk_heap",       M_BRK_HEAP       },
+  };
+
+
+
+/**
+ * Change a parameter of the memory allocator.
+ * 
+ * @param   param  The parameter to change.
+ * @param   value  The new value of the parameter.
+ * @return         1 on success, 0 on error.
+ */
+static int tune(int param, size_t value)
+{
+  switch (param)
+    {
+    case M_MMAP_THRESHOLD:
+      if (value > HEAP_SMALL_MAX)
+	value = HEAP_SMALL_MAX;
+      return !__slibc_heap_set_mmap_threshold(value);
+    
+    case M_CACHE_SIZE:
+      __slibc_heap_cache_bytes = value;
+      return 1;
+    
+    case M_PURGE_DECAY:
+      __slibc_heap_retain_decay = value;
+      return 1;
+    
+    case M_HUGE_THRESHOLD:
+      __slibc_heap_huge_threshold = value;
+      return 1;
+    
+    case M_CPU_CACHES:
+      return !__slibc_heap_use_cpu_caches(value != 0);
+    
+    case M_BRK_HEAP:
+      __slibc_heap_brk = value != 0;
+      return 1;
+    
+    default:
+      return 0;
+    }
+}
+
+
+/**
+ * Change a parameter of the memory allocator.
+ * 
+ * This is a SVID extension.
+ * 
+ * @etymology  (`malloc`)-subsystem: set (opt)ion.
+ * 
+ * @param   param  The parameter to change.
+ * @param   value  The new value of the parameter.
+ * @return         1 on success, 0 on error.
+ * 
+ * @since  Always.
+ */
+int mallopt(int param, int value)
+{
+  if (value < 0)
+    return 0;
+  return tune(param, (size_t)value);
+}
+
+
+/**
+ * Set the parameters listed in the environment variable
+ * `SLIBC_MALLOC_CONF`, as comma-separated `name:value`
+ * pairs. The values may be suffixed with `k`, `M`, or `G`
+ * for kibibytes, mebibytes, or gibibytes. Unrecognised
+ * parameters, and values that do not fit in a `size_t`,
+ * are ignored.
+ * 
+ * This is called when the heap is initialised.
+ */
+void __slibc_heap_configure(void)
+{
+  const char* conf = getenv("SLIBC_MALLOC_CONF");
+  const char* name;
+  size_t i, n, value, shift;
+  int valid;
+  
+  if (conf == NULL)
+    return;
+  
+  while (*conf)
+    {
+      name = conf;
+      while (*conf && (*conf != ':') && (*conf != ','))
+	conf++;
+      n = (size_t)(conf - name);
+      
+      value = 0, valid = 1;
+      if (*conf == ':')
+	for (conf++; ('0' <= *conf) && (*conf <= '9'); conf++)
+	  if (__builtin_umull_overflow(value, 10, &value) ||
+	      __builtin_uaddl_overflow(value, (size_t)(*conf - '0'), &value))
+	    valid = 0;
+      switch (*conf)
+	{
+	case 'k':  shift = 10;  break;
+	case 'M':  shift = 20;  break;
+	case 'G':  shift = 30;  break;
+	default:
+	  shift = 0;
+	  break;
+	}
+      if (value > (SIZE_MAX >> shift))
+	valid = 0;
+      value <<= shift;
+      
+      for (i = 0; valid && (i < sizeof(tunables) / sizeof(*tunables)); i++)
+	if (!strncmp(name, tunables[i].name, n) && !tunables[i].name[n])
+	  tune(tunables[i].param, value);
+      
+      while (*conf && (*conf++ != ','));
+    }
+}
+
@@ -0,0 +1,480 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <obstack.h>
+
+
+
+/**
+ * Initialise an obstack, chunks are allocated with
+ * `obstack_chunk_alloc` and deallocated with
+ * `obstack_chunk_free`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     1 on success, 0 if the first chunk cannot be
+ *             allocated and `obstack_alloc_failed_handler`
+ *             returns.
+ * 
+ * @since  Always.
+ */
+int (obstack_init)(struct obstack* h)
+{
+  return obstack_init(h);
+}
+
+
+/**
+ * Variant of `obstack_init` where the
+ * preferred chunk size is specified.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h     The obstack.
+ * @param   size  The preferred chunk size, zero for the default.
+ * @return        1 on success, 0 if the first chunk cannot be
+ *                allocated and `obstack_alloc_failed_handler`
+ *                returns.
+ * 
+ * @since  Always.
+ */
+int (obstack_begin)(struct obstack* h, size_t size)
+{
+  return obstack_begin(h, size);
+}
+
+
+/**
+ * Variant of `obstack_init` where the preferred
+ * chunk size, the alignment of objects, and the
+ * functions used to allocate and deallocate chunks
+ * are specified.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h          The obstack.
+ * @param   size       The preferred chunk size, zero for the default.
+ * @param   alignment  The alignment of objects, zero for the default.
+ * @param   chunkfun   The function used to allocate chunks.
+ * @param   freefun    The function used to deallocate chunks.
+ * @return             1 on success, 0 if the first chunk cannot be
+ *                     allocated and `obstack_alloc_failed_handler`
+ *                     returns.
+ * 
+ * @since  Always.
+ */
+int (obstack_specify_allocation)(struct obstack* h, size_t size, size_t alignment,
+				 void* (*chunkfun)(size_t), void (*freefun)(void*))
+{
+  return obstack_specify_allocation(h, size, alignment, chunkfun, freefun);
+}
+
+
+/**
+ * Variant of `obstack_specify_allocation` where
+ * `arg` is passed as the first argument to
+ * `chunkfun` and `freefun`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h          The obstack.
+ * @param   size       The preferred chunk size, zero for the default.
+ * @param   alignment  The alignment of objects, zero for the default.
+ * @param   chunkfun   The function used to allocate chunks.
+ * @param   freefun    The function used to deallocate chunks.
+ * @param   arg        The first argument for `chunkfun` and `freefun`.
+ * @return             1 on success, 0 if the first chunk cannot be
+ *                     allocated and `obstack_alloc_failed_handler`
+ *                     returns.
+ * 
+ * @since  Always.
+ */
+int (obstack_specify_allocation_with_arg)(struct obstack* h, size_t size, size_t alignment,
+					  void* (*chunkfun)(void*, size_t),
+					  void (*freefun)(void*, void*), void* arg)
+{
+  return obstack_specify_allocation_with_arg(h, size, alignment, chunkfun, freefun, arg);
+}
+
+
+/**
+ * Get the total size of the chunks of an obstack.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The total size of the obstack's chunks.
+ * 
+ * @since  Always.
+ */
+size_t (obstack_memory_used)(struct obstack* h)
+{
+  return obstack_memory_used(h);
+}
+
+
+/**
+ * Get the beginning of the growing object of an obstack.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The beginning of the growing object. It
+ *             may change when the object is grown.
+ * 
+ * @since  Always.
+ */
+void* (obstack_base)(struct obstack* h)
+{
+  return obstack_base(h);
+}
+
+
+/**
+ * Get the end of the growing object of an obstack.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The end of the growing object. It
+ *             may change when the object is grown.
+ * 
+ * @since  Always.
+ */
+void* (obstack_next_free)(struct obstack* h)
+{
+  return obstack_next_free(h);
+}
+
+
+/**
+ * Get the size of the growing object of an obstack.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The size of the growing object.
+ * 
+ * @since  Always.
+ */
+size_t (obstack_object_size)(struct obstack* h)
+{
+  return obstack_object_size(h);
+}
+
+
+/**
+ * Get the number of bytes the growing object of
+ * an obstack can grow by without being moved to
+ * a new chunk.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The space left in the current chunk.
+ * 
+ * @since  Always.
+ */
+size_t (obstack_room)(struct obstack* h)
+{
+  return obstack_room(h);
+}
+
+
+/**
+ * Check whether an obstack is empty.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     1 if no objects have been allocated,
+ *             and the growing object is empty,
+ *             0 otherwise.
+ * 
+ * @since  Always.
+ */
+int (obstack_empty_p)(struct obstack* h)
+{
+  return obstack_empty_p(h);
+}
+
+
+/**
+ * Make sure that the growing object of an obstack
+ * can grow by a number of bytes without being moved
+ * to a new chunk. It is moved if necessary.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h       The obstack.
+ * @param  length  The number of bytes.
+ * 
+ * @since  Always.
+ */
+void (obstack_make_room)(struct obstack* h, size_t length)
+{
+  obstack_make_room(h, length);
+}
+
+
+/**
+ * Grow the growing object of an obstack by
+ * a number of uninitialised bytes.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h       The obstack.
+ * @param  length  The number of bytes.
+ * 
+ * @since  Always.
+ */
+void (obstack_blank)(struct obstack* h, size_t length)
+{
+  obstack_blank(h, length);
+}
+
+
+/**
+ * Grow the growing object of an obstack by a copy
+ * of a memory segment.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h       The obstack.
+ * @param  data    The memory segment.
+ * @param  length  The size of the memory segment.
+ * 
+ * @since  Always.
+ */
+void (obstack_grow)(struct obstack* h, const void* data, size_t length)
+{
+  obstack_grow(h, data, length);
+}
+
+
+/**
+ * Variant of `obstack_grow` that also
+ * appends a NUL byte.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h       The obstack.
+ * @param  data    The memory segment.
+ * @param  length  The size of the memory segment.
+ * 
+ * @since  Always.
+ */
+void (obstack_grow0)(struct obstack* h, const void* data, size_t length)
+{
+  obstack_grow0(h, data, length);
+}
+
+
+/**
+ * Grow the growing object of an obstack by one byte.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h  The obstack.
+ * @param  c  The byte.
+ * 
+ * @since  Always.
+ */
+void (obstack_1grow)(struct obstack* h, int c)
+{
+  obstack_1grow(h, c);
+}
+
+
+/**
+ * Grow the growing object of an obstack by a pointer.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h      The obstack.
+ * @param  datum  The pointer.
+ * 
+ * @since  Always.
+ */
+void (obstack_ptr_grow)(struct obstack* h, void* datum)
+{
+  obstack_ptr_grow(h, datum);
+}
+
+
+/**
+ * Grow the growing object of an obstack by an `int`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h      The obstack.
+ * @param  datum  The integer.
+ * 
+ * @since  Always.
+ */
+void (obstack_int_grow)(struct obstack* h, int datum)
+{
+  obstack_int_grow(h, datum);
+}
+
+
+/**
+ * Variant of `obstack_1grow` that does not check
+ * that there is room for the byte, see `obstack_room`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h  The obstack.
+ * @param  c  The byte.
+ * 
+ * @since  Always.
+ */
+void (obstack_1grow_fast)(struct obstack* h, int c)
+{
+  obstack_1grow_fast(h, c);
+}
+
+
+/**
+ * Variant of `obstack_ptr_grow` that does not check
+ * that there is room for the pointer, see `obstack_room`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h      The obstack.
+ * @param  datum  The pointer.
+ * 
+ * @since  Always.
+ */
+void (obstack_ptr_grow_fast)(struct obstack* h, void* datum)
+{
+  obstack_ptr_grow_fast(h, datum);
+}
+
+
+/**
+ * Variant of `obstack_int_grow` that does not check
+ * that there is room for the integer, see `obstack_room`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h      The obstack.
+ * @param  datum  The integer.
+ * 
+ * @since  Always.
+ */
+void (obstack_int_grow_fast)(struct obstack* h, int datum)
+{
+  obstack_int_grow_fast(h, datum);
+}
+
+
+/**
+ * Variant of `obstack_blank` that does not check
+ * that there is room for the bytes, see `obstack_room`.
+ * The growing object can be shrunk by passing the
+ * negated number of bytes.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h       The obstack.
+ * @param  length  The number of bytes.
+ * 
+ * @since  Always.
+ */
+void (obstack_blank_fast)(struct obstack* h, size_t length)
+{
+  obstack_blank_fast(h, length);
+}
+
+
+/**
+ * Finish the growing object of an obstack,
+ * and start a new, empty, growing object.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h  The obstack.
+ * @return     The finished object. It will not be
+ *             moved anymore.
+ * 
+ * @since  Always.
+ */
+void* (obstack_finish)(struct obstack* h)
+{
+  return obstack_finish(h);
+}
+
+
+/**
+ * Allocate an uninitialised object in an obstack.
+ * This is equivalent to `obstack_blank` followed
+ * by `obstack_finish`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h       The obstack.
+ * @param   length  The size of the object.
+ * @return          The object.
+ * 
+ * @since  Always.
+ */
+void* (obstack_alloc)(struct obstack* h, size_t length)
+{
+  return obstack_alloc(h, length);
+}
+
+
+/**
+ * Copy a memory segment to a new object in
+ * an obstack. This is equivalent to `obstack_grow`
+ * followed by `obstack_finish`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h       The obstack.
+ * @param   data    The memory segment.
+ * @param   length  The size of the memory segment.
+ * @return          The object.
+ * 
+ * @since  Always.
+ */
+void* (obstack_copy)(struct obstack* h, const void* data, size_t length)
+{
+  return obstack_copy(h, data, length);
+}
+
+
+/**
+ * Variant of `obstack_copy` that also
+ * appends a NUL byte.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h       The obstack.
+ * @param   data    The memory segment.
+ * @param   length  The size of the memory segment.
+ * @return          The object.
+ * 
+ * @since  Always.
+ */
+void* (obstack_copy0)(struct obstack* h, const void* data, size_t length)
+{
+  return obstack_copy0(h, data, length);
+}
+
@@ -0,0 +1,377 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <obstack.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <string.h>
+#include <slibc-alloc.h>
+#include <err.h>
+
+
+
+/**
+ * The default preferred chunk size. Chunks are
+ * allocated with `malloc` by default, and this
+ * is the largest size it serves from its size
+ * classes rather than from a mapping of its own.
+ */
+#define DEFAULT_CHUNK_SIZE  16384
+
+/**
+ * The default alignment of objects.
+ */
+#define DEFAULT_ALIGNMENT  (__alignof__(max_align_t))
+
+
+/**
+ * Allocate a chunk for an obstack.
+ * 
+ * @param   h     The obstack.
+ * @param   size  The size of the chunk.
+ * @return        The chunk, `NULL` on error.
+ */
+#define CALL_CHUNKFUN(h, size)					\
+  ((h)->use_extra_arg						\
+   ? (h)->chunkfun.extra((h)->extra_arg, (size))		\
+   : (h)->chunkfun.plain(size))
+
+/**
+ * Deallocate a chunk in an obstack.
+ * 
+ * @param  h      The obstack.
+ * @param  chunk  The chunk.
+ */
+#define CALL_FREEFUN(h, chunk)					\
+  ((h)->use_extra_arg						\
+   ? (h)->freefun.extra((h)->extra_arg, (chunk))		\
+   : (h)->freefun.plain(chunk))
+
+
+
+/**
+ * The default `obstack_alloc_failed_handler`.
+ */
+static void print_and_abort(void)
+{
+  errx(obstack_exit_failure, "memory exhausted");
+}
+
+
+/**
+ * The function that is called if a chunk cannot be allocated.
+ * It shall not return. The default function prints an error
+ * message and exits the process with the status
+ * `obstack_exit_failure`.
+ * 
+ * This is a GNU extension.
+ * 
+ * @since  Always.
+ */
+void (*obstack_alloc_failed_handler)(void) = print_and_abort;
+
+
+/**
+ * The exit status used by the default
+ * `obstack_alloc_failed_handler`,
+ * `EXIT_FAILURE` by default.
+ * 
+ * This is a GNU extension.
+ * 
+ * @since  Always.
+ */
+int obstack_exit_failure = EXIT_FAILURE;
+
+
+
+/**
+ * The function `obstack_init` and `obstack_begin` use
+ * to allocate chunks. It can be replaced by defining
+ * `obstack_chunk_alloc` as a macro, otherwise chunks
+ * are allocated with `malloc`.
+ * 
+ * This is a slibc extension.
+ * 
+ * @param   size  The size of the chunk.
+ * @return        The chunk, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* obstack_chunk_alloc(size_t size)
+{
+  return malloc(size);
+}
+
+
+/**
+ * The function `obstack_init` and `obstack_begin` use
+ * to deallocate chunks. It can be replaced by defining
+ * `obstack_chunk_free` as a macro, otherwise chunks
+ * are deallocated with `free`.
+ * 
+ * This is a slibc extension.
+ * 
+ * @param  chunk  The chunk.
+ * 
+ * @since  Always.
+ */
+void obstack_chunk_free(void* chunk)
+{
+  fast_free(chunk);
+}
+
+
+/**
+ * Initialise an obstack, and allocate its first chunk.
+ * 
+ * @param   h          The obstack, with `chunkfun`, `freefun`,
+ *                     `extra_arg`, and `use_extra_arg` set.
+ * @param   size       The preferred chunk size, zero for the default.
+ * @param   alignment  The alignment of objects, zero for the default.
+ * @return             1 on success, 0 if the first chunk cannot be
+ *                     allocated and `obstack_alloc_failed_handler`
+ *                     returns.
+ */
+static int obstack_begin_common(struct obstack* h, size_t size, size_t alignment)
+{
+  struct _obstack_chunk* chunk;
+  
+  if (alignment == 0)
+    alignment = DEFAULT_ALIGNMENT;
+  if (size == 0)
+    size = DEFAULT_CHUNK_SIZE;
+  
+  h->chunk_size = size;
+  h->alignment_mask = alignment - 1;
+  
+  h->chunk = chunk = CALL_CHUNKFUN(h, size);
+  if (chunk == NULL)
+    {
+      obstack_alloc_failed_handler();
+      return 0;
+    }
+  h->next_free = h->object_base = __OBSTACK_ALIGN(h, chunk->contents);
+  h->chunk_limit = chunk->limit = (char*)chunk + size;
+  chunk->prev = NULL;
+  h->maybe_empty_object = 0;
+  h->alloc_failed = 0;
+  return 1;
+}
+
+
+/**
+ * Initialise an obstack.
+ * 
+ * Use `obstack_init`, `obstack_begin`,
+ * `obstack_specify_allocation` instead.
+ * 
+ * @param   h          The obstack.
+ * @param   size       The preferred chunk size, zero for the default.
+ * @param   alignment  The alignment of objects, zero for the default.
+ * @param   chunkfun   The function used to allocate chunks.
+ * @param   freefun    The function used to deallocate chunks.
+ * @return             1 on success, 0 if the first chunk cannot be
+ *                     allocated and `obstack_alloc_failed_handler`
+ *                     returns.
+ * 
+ * @since  Always.
+ */
+int _obstack_begin(struct obstack* h, size_t size, size_t alignment,
+		   void* (*chunkfun)(size_t), void (*freefun)(void*))
+{
+  h->chunkfun.plain = chunkfun;
+  h->freefun.plain = freefun;
+  h->extra_arg = NULL;
+  h->use_extra_arg = 0;
+  return obstack_begin_common(h, size, alignment);
+}
+
+
+/**
+ * Initialise an obstack.
+ * 
+ * Use `obstack_specify_allocation_with_arg` instead.
+ * 
+ * @param   h          The obstack.
+ * @param   size       The preferred chunk size, zero for the default.
+ * @param   alignment  The alignment of objects, zero for the default.
+ * @param   chunkfun   The function used to allocate chunks.
+ * @param   freefun    The function used to deallocate chunks.
+ * @param   arg        The first argument for `chunkfun` and `freefun`.
+ * @return             1 on success, 0 if the first chunk cannot be
+ *                     allocated and `obstack_alloc_failed_handler`
+ *                     returns.
+ * 
+ * @since  Always.
+ */
+int _obstack_begin_1(struct obstack* h, size_t size, size_t alignment,
+		     void* (*chunkfun)(void*, size_t), void (*freefun)(void*, void*), void* arg)
+{
+  h->chunkfun.extra = chunkfun;
+  h->freefun.extra = freefun;
+  h->extra_arg = arg;
+  h->use_extra_arg = 1;
+  return obstack_begin_common(h, size, alignment);
+}
+
+
+/**
+ * Move the growing object of an obstack to
+ * a new chunk, with room for at least
+ * `length` more bytes.
+ * 
+ * Use `obstack_make_room` instead.
+ * 
+ * @param  h       The obstack.
+ * @param  length  The number of bytes the object will grow by.
+ * 
+ * @since  Always.
+ */
+void _obstack_newchunk(struct obstack* h, size_t length)
+{
+  struct _obstack_chunk* old_chunk = h->chunk;
+  struct _obstack_chunk* new_chunk;
+  size_t obj_size = (size_t)(h->next_free - h->object_base);
+  size_t new_size, sum1, sum2;
+  char* object_base;
+  
+  /* Leave room for the object to grow further,
+   * so that it is not moved again too soon. */
+  if (__builtin_uaddl_overflow(obj_size, length, &sum1) ||
+      __builtin_uaddl_overflow(sum1, offsetof(struct _obstack_chunk, contents) + h->alignment_mask, &sum2) ||
+      __builtin_uaddl_overflow(sum2, (obj_size >> 3) + 100, &new_size))
+    {
+      /* The handler should not return, but if it does,
+       * the obstack is left unchanged. */
+      obstack_alloc_failed_handler();
+      return;
+    }
+  if (new_size < h->chunk_size)
+    new_size = h->chunk_size;
+  
+  new_chunk = CALL_CHUNKFUN(h, new_size);
+  if (new_chunk == NULL)
+    {
+      obstack_alloc_failed_handler();
+      return;
+    }
+  h->chunk = new_chunk;
+  new_chunk->prev = old_chunk;
+  new_chunk->limit = h->chunk_limit = (char*)new_chunk + new_size;
+  
+  object_base = __OBSTACK_ALIGN(h, new_chunk->contents);
+  memcpy(object_base, h->object_base, obj_size);
+  
+  /* If the growing object was the only object in the
+   * old chunk, the old chunk is no longer needed. */
+  if (!h->maybe_empty_object && (h->object_base == __OBSTACK_ALIGN(h, old_chunk->contents)))
+    {
+      new_chunk->prev = old_chunk->prev;
+      CALL_FREEFUN(h, old_chunk);
+    }
+  
+  h->object_base = object_base;
+  h->next_free = object_base + obj_size;
+  h->maybe_empty_object = 0;
+}
+
+
+/**
+ * Deallocate an object in an obstack, and all
+ * objects allocated after it. If `obj` is `NULL`,
+ * all objects are deallocated, and the obstack
+ * must be initialised again before it is reused.
+ * 
+ * The process is aborted if `obj` is not in the obstack.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param  h    The obstack.
+ * @param  obj  The object, or `NULL`.
+ * 
+ * @since  Always.
+ */
+void (obstack_free)(struct obstack* h, void* obj)
+{
+  struct _obstack_chunk* chunk = h->chunk;
+  struct _obstack_chunk* prev;
+  
+  /* Objects are allocated in increasing order in a
+   * chunk, so all chunks newer than the one that
+   * contains `obj` can be deallocated. */
+  while ((chunk != NULL) && (((char*)obj <= (char*)chunk) || ((char*)obj > chunk->limit)))
+    {
+      prev = chunk->prev;
+      CALL_FREEFUN(h, chunk);
+      chunk = prev;
+      /* `obj` may be at the end of an empty object at
+       * the end of the chunk it is in. */
+      h->maybe_empty_object = 1;
+    }
+  
+  if (chunk != NULL)
+    {
+      h->object_base = h->next_free = obj;
+      h->chunk_limit = chunk->limit;
+      h->chunk = chunk;
+    }
+  else if (obj != NULL)
+    abort();
+}
+
+
+/**
+ * Get the amount of memory used by an obstack.
+ * 
+ * Use `obstack_memory_used` instead.
+ * 
+ * @param   h  The obstack.
+ * @return     The total size of the obstack's chunks.
+ * 
+ * @since  Always.
+ */
+size_t _obstack_memory_used(struct obstack* h)
+{
+  struct _obstack_chunk* chunk;
+  size_t n = 0;
+  for (chunk = h->chunk; chunk != NULL; chunk = chunk->prev)
+    n += (size_t)(chunk->limit - (char*)chunk);
+  return n;
+}
+
+
+/**
+ * Check whether a pointer points into an obstack.
+ * 
+ * @param   h    The obstack.
+ * @param   obj  The pointer.
+ * @return       1 if `obj` is in one of the obstack's
+ *               chunks, 0 otherwise.
+ * 
+ * @since  Always.
+ */
+int _obstack_allocated_p(struct obstack* h, void* obj)
+{
+  struct _obstack_chunk* chunk;
+  for (chunk = h->chunk; chunk != NULL; chunk = chunk->prev)
+    if (((char*)obj > (char*)chunk) && ((char*)obj <= chunk->limit))
+      return 1;
+  return 0;
+}
+
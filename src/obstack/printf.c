@@ -0,0 +1,87 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <obstack.h>
+#include <stdarg.h>
+#include <stdio.h>
+
+
+
+/**
+ * Grow the growing object of an obstack
+ * by a formatted string, not including
+ * the terminating NUL byte.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h       The obstack.
+ * @param   format  The formatting-string, see `printf`.
+ * @param   ...     The formatting-arguments.
+ * @return          The number of written bytes, -1 on error.
+ * 
+ * @throws  EINVAL  `format` contained unsupported formatting codes.
+ * 
+ * @since  Always.
+ */
+int obstack_printf(struct obstack* h, const char* format, ...)
+{
+  int r;
+  va_list args;
+  va_start(args, format);
+  r = obstack_vprintf(h, format, args);
+  va_end(args);
+  return r;
+}
+
+
+/**
+ * This function is identical to `obstack_printf`,
+ * except it uses `va_list` instead of variadic arguments.
+ * 
+ * This is a GNU extension.
+ * 
+ * @param   h       The obstack.
+ * @param   format  The formatting-string, see `printf`.
+ * @param   args    The formatting-arguments.
+ * @return          The number of written bytes, -1 on error.
+ * 
+ * @throws  EINVAL  `format` contained unsupported formatting codes.
+ * 
+ * @since  Always.
+ */
+int obstack_vprintf(struct obstack* h, const char* format, va_list args)
+{
+  va_list args_copy;
+  int n;
+  
+  /* Format directly into the chunk, and only format
+   * a second time if the string did not fit. */
+  va_copy(args_copy, args);
+  n = vsnprintf(h->next_free, obstack_room(h), format, args_copy);
+  va_end(args_copy);
+  if (n < 0)
+    return -1;
+  if ((size_t)n >= obstack_room(h))
+    {
+      obstack_make_room(h, (size_t)n + 1);
+      vsnprintf(h->next_free, (size_t)n + 1, format, args);
+    }
+  
+  obstack_blank_fast(h, n);
+  return n;
+}
+
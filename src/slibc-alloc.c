@@ -21,36 +21,7 @@
 #include <string.h>
 #include <strings.h>
 #include <errno.h>
-/* TODO #include <sys/mman.h> */
-
-
-
-/**
- * Get the alignment-shift of a pointer.
- * 
- * @param   p:void*  The pointer.
- * @return  :size_t  The number of bytes added for alignment.
- *                   This excludes the information this macro
- *                   reads, and the storage of the allocation-size.
- */
-#define __ALIGN(p)      (*(size_t*)(((char*)(p)) - sizeof(size_t)))
-
-/**
- * Get the allocated pointer from a returned pointer.
- * 
- * @param   p:void*  The pointer returned by a `malloc`-family function.
- * @return           The pointer allocated by a `malloc`-family function.
- */
-#define PURE_ALLOC(p)   (((char*)(p)) - (__ALIGN(p) + 2 * sizeof(size_t)))
-
-/**
- * Get the real allocation is of a pointer, including
- * the size of the metadata storage and the alignment-padding.
- * 
- * @param   p:void*  The pointer.
- * @return  :size_t  The real allocation size of the pointer.
- */
-#define PURE_SIZE(p)    (*(size_t*)PURE_ALLOC(p) + 2 * sizeof(size_t))
+#include "malloc/heap.h"
 
 
 
@@ -71,7 +42,7 @@ void fast_free(void* segment)
   int saved_errno = errno;
   if (segment == NULL)
     return;
-  munmap(PURE_ALLOC(segment), PURE_SIZE(segment));
+  __slibc_heap_free(segment);
   errno = saved_errno;
 }
 
@@ -93,12 +64,66 @@ void secure_free(void* segment)
   int saved_errno = errno;
   if (segment == NULL)
     return;
-  explicit_bzero(PURE_ALLOC(segment), PURE_SIZE(segment));
+  __slibc_heap_wipe(segment, 0, heap_size_of(segment));
   fast_free(segment);
   errno = saved_errno;
 }
 
 
+/**
+ * This function is identical to `free_sized`, except it is
+ * guaranteed to override the memory segment with zeroes
+ * before freeing the allocation.
+ * 
+ * `errno` is guaranteed not to be set.
+ * 
+ * @etymology  (Secure) variant of (`free_sized`).
+ * 
+ * @param  segment  The memory segment to free.
+ * @param  size     The size of the memory segment,
+ *                  as it was requested when allocated.
+ * 
+ * @since  Always.
+ */
+void secure_free_sized(void* segment, size_t size)
+{
+  int saved_errno = errno;
+  if (segment == NULL)
+    return;
+  __slibc_heap_wipe(segment, 0, size);
+  __slibc_heap_free_sized(segment, 0, size);
+  errno = saved_errno;
+}
+
+
+/**
+ * This function is identical to `free_aligned_sized`,
+ * except it is guaranteed to override the memory segment
+ * with zeroes before freeing the allocation.
+ * 
+ * `errno` is guaranteed not to be set.
+ * 
+ * @etymology  (Secure) variant of (`free_aligned_sized`).
+ * 
+ * @param  segment    The memory segment to free.
+ * @param  alignment  The alignment of the memory segment,
+ *                    as it was requested when allocated.
+ * @param  size       The size of the memory segment,
+ *                    as it was requested when allocated.
+ * 
+ * @since  Always.
+ */
+void secure_free_aligned_sized(void* segment, size_t alignment, size_t size)
+{
+  int saved_errno = errno;
+  if (segment == NULL)
+    return;
+  __slibc_heap_wipe(segment, 0, size);
+  __slibc_heap_free_sized(segment, alignment, size);
+  errno = saved_errno;
+}
+
+
 /**
  * This function returns the allocation size of
  * a memory segment.
@@ -131,7 +156,32 @@ size_t allocsize(void* segment)
       errno = EINVAL;
       return 0;
     }
-  return *(size_t*)PURE_ALLOC(segment);
+  return heap_size_of(segment);
+}
+
+
+/**
+ * Copy an allocation to a new allocation, without first
+ * trying to resize it in place. The old allocation is
+ * not deallocated.
+ * 
+ * @param   ptr       The old allocation.
+ * @param   boundary  The alignment of the new allocation.
+ * @param   size      The new allocation size.
+ * @return            The new allocation, `NULL` on error.
+ * 
+ * @throws  EINVAL  `boundary` is not a power of two.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+__GCC_ONLY(__attribute__((nonnull, warn_unused_result)))
+static void* realloc_copy(void* ptr, size_t boundary, size_t size)
+{
+  size_t old_size = allocsize(ptr);
+  void* new_ptr = memalign(boundary, size);
+  if (new_ptr == NULL)
+    return NULL;
+  HEAP_COUNT(realloc_copied, 1);
+  return memcpy(new_ptr, ptr, old_size < size ? old_size : size);
 }
 
 
@@ -151,29 +201,34 @@ size_t allocsize(void* segment)
 									\
   if (size == 0)							\
     return secure_free(ptr), NULL;					\
-			   						\
+									\
   if (ptr == NULL)	   						\
-    return CLEAR_NEW ? malloc(size) : calloc(1, size);			\
-			   						\
+    return CLEAR_NEW ? calloc(1, size) : malloc(size);			\
+									\
   old_size = allocsize(ptr);						\
   if (old_size == size)							\
     return ptr;								\
 									\
   if (CLEAR_OLD ? (old_size > size) : 0)				\
-    explicit_bzero(((char*)ptr) + size, old_size - size);		\
+    __slibc_heap_wipe(ptr, size, old_size - size);			\
 									\
-  new_ptr = naive_realloc(ptr, sizeof(max_align_t), size);		\
-  if (new_ptr != ptr)							\
+  /* Large allocations are moved without copying. Resizing		\
+   * in place is not retried if it fails, it has been tried. */		\
+  new_ptr = __slibc_heap_move(ptr, __alignof__(max_align_t), size);	\
+  if ((new_ptr == NULL) && (errno == 0))				\
     {									\
+      new_ptr = realloc_copy(ptr, __alignof__(max_align_t), size);	\
       if (new_ptr == NULL)						\
 	return NULL;							\
       if (CLEAR_FREE)							\
-	explicit_bzero(PURE_ALLOC(ptr), PURE_SIZE(ptr));		\
+	__slibc_heap_wipe(ptr, 0, old_size);				\
       fast_free(ptr);							\
     }									\
+  else if (new_ptr == NULL)						\
+    return NULL;							\
 									\
   if (CLEAR_NEW ? (old_size < size) : 0)				\
-    explicit_bzero(((char*)new_ptr) + old_size, size - old_size);	\
+    __slibc_heap_clear(new_ptr, old_size, size - old_size);		\
 									\
   return new_ptr
 
@@ -306,15 +361,19 @@ void* extalloc(void* ptr, size_t size, enum extalloc_mode mode)
   void* new_ptr;
   
   if (clear ? (old_size > size) : 0)
-    explicit_bzero(((char*)ptr) + size, old_size - size);
+    __slibc_heap_wipe(ptr, size, old_size - size);
   
-  new_ptr = (mode & EXTALLOC_MALLOC)
-	     ? naive_realloc(ptr, sizeof(max_align_t), size)
-	     : naive_extalloc(ptr, size);
+  new_ptr = naive_extalloc(ptr, size);
+  if (new_ptr == NULL)
+    HEAP_COUNT(extalloc_failed, 1);
+  else
+    HEAP_COUNT(extalloc_in_place, 1);
+  if ((new_ptr == NULL) && (errno == 0) && (mode & EXTALLOC_MALLOC))
+    new_ptr = malloc(size);
   if ((new_ptr != ptr) && (new_ptr != NULL))
     {
       if (clear)
-	explicit_bzero(PURE_ALLOC(ptr), PURE_SIZE(ptr));
+	__slibc_heap_wipe(ptr, 0, old_size);
       fast_free(ptr);
     }
   
@@ -363,7 +422,7 @@ void* rememalign(void* ptr, size_t boundary, size_t size, enum rememalign_mode m
     {
       new_ptr = memalign(boundary, size);
       if ((new_ptr != NULL) && conf_init)
-	bzero(new_ptr, size);
+	__slibc_heap_clear(new_ptr, 0, size);
       return new_ptr;
     }
   
@@ -372,27 +431,42 @@ void* rememalign(void* ptr, size_t boundary, size_t size, enum rememalign_mode m
     return ptr;
   
   if (conf_clear ? (old_size > size) : 0)
-    explicit_bzero(((char*)ptr) + size, old_size - size);
+    __slibc_heap_wipe(ptr, size, old_size - size);
   
   if (conf_memcpy)
-    new_ptr = naive_realloc(ptr, boundary, size);
+    {
+      /* Large allocations are moved without copying. Resizing
+       * in place is not retried if it fails, it has been tried. */
+      new_ptr = __slibc_heap_move(ptr, boundary, size);
+      if ((new_ptr == NULL) && (errno == 0))
+	{
+	  new_ptr = realloc_copy(ptr, boundary, size);
+	  if (new_ptr == NULL)
+	    return NULL;
+	  if (conf_clear)
+	    __slibc_heap_wipe(ptr, 0, old_size);
+	  fast_free(ptr);
+	}
+      else if (new_ptr == NULL)
+	return NULL;
+    }
   else
     {
       new_ptr = naive_extalloc(ptr, size);
       if ((new_ptr == NULL) && (errno == 0))
 	new_ptr = memalign(boundary, size);
-    }
-  if (new_ptr != ptr)
-    {
-      if (new_ptr == NULL)
-	return NULL;
-      if (conf_clear)
-	explicit_bzero(PURE_ALLOC(ptr), PURE_SIZE(ptr));
-      fast_free(ptr);
+      if (new_ptr != ptr)
+	{
+	  if (new_ptr == NULL)
+	    return NULL;
+	  if (conf_clear)
+	    __slibc_heap_wipe(ptr, 0, old_size);
+	  fast_free(ptr);
+	}
     }
   
   if (conf_init ? (old_size < size) : 0)
-    explicit_bzero(((char*)new_ptr) + old_size, size - old_size);
+    __slibc_heap_clear(new_ptr, old_size, size - old_size);
   
   return new_ptr;
 }
@@ -424,9 +498,12 @@ void* rememalign(void* ptr, size_t boundary, size_t size, enum rememalign_mode m
  */
 void* naive_realloc(void* ptr, size_t boundary, size_t size)
 {
-  /* TODO implementation of naive_realloc with reallocation */
-  return memalign(boundary, size);
-  (void) ptr;
+  void* new_ptr = naive_extalloc(ptr, size);
+  if (new_ptr != NULL)
+    return HEAP_COUNT(realloc_in_place, 1), new_ptr;
+  if (errno != 0)
+    return NULL;
+  return realloc_copy(ptr, boundary, size);
 }
 
 
@@ -449,9 +526,67 @@ void* naive_realloc(void* ptr, size_t boundary, size_t size)
  */
 void* naive_extalloc(void* ptr, size_t size)
 {
-  /* TODO implement naive_extalloc */
-  return errno = 0, NULL;
-  (void) ptr, (void) size;
+  return __slibc_heap_resize(ptr, size);
+}
+
+
+/**
+ * Allocation procedure for `falloc`.
+ * 
+ * The heap does not store a header before allocations,
+ * and aligned allocations are carved directly from
+ * naturally aligned blocks, so no shift is required.
+ * The caller keeps track of the size, so the heap
+ * does not record it either.
+ * 
+ * @param   alignment  The aligment of the new pointer.
+ * @param   size       The size of the allocation, must not be zero.
+ * @return             The new pointer, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+__GCC_ONLY(__attribute__((malloc, warn_unused_result)))
+static inline void* falloc_malloc(size_t alignment, size_t size)
+{
+  return __slibc_heap_alloc_unsized(alignment, size);
+}
+
+
+/**
+ * Deallocation procedure for `falloc`.
+ * 
+ * @param  ptr        The pointer to deallocate.
+ * @param  alignment  The aligment of the pointer.
+ * @param  size       The size of the allocation.
+ * 
+ * @since  Always.
+ */
+__GCC_ONLY(__attribute__((nonnull)))
+static inline void falloc_free(void* ptr, size_t alignment, size_t size)
+{
+  __slibc_heap_free_sized(ptr, alignment, size);
+}
+
+
+/**
+ * Resize procedure for `falloc`.
+ * 
+ * @param   ptr        The old pointer.
+ * @param   alignment  The aligment of the pointer.
+ * @param   size       The new allocation size.
+ * @return             `ptr` on success, `NULL` with `errno` set to
+ *                     zero if a new allocation is required.
+ * 
+ * @throws  0  A new allocation is required.
+ * 
+ * @since  Always.
+ */
+__GCC_ONLY(__attribute__((nonnull, warn_unused_result)))
+static inline void* falloc_extalloc(void* ptr, size_t alignment, size_t size)
+{
+  return __slibc_heap_resize_unsized(ptr, alignment, size);
 }
 
 
@@ -479,23 +614,19 @@ static inline void* falloc_realloc(void* ptr, size_t* ptrshift, size_t alignment
 				   size_t old_size, size_t new_size, enum falloc_mode mode)
 {
   void* new_ptr = NULL;
-  size_t shift = *ptrshift;
   
   if ((mode & FALLOC_CLEAR) && (old_size > new_size))
-    explicit_bzero(ptr + new_size, old_size - new_size);
+    __slibc_heap_wipe(ptr, new_size, old_size - new_size);
   
-  new_ptr = falloc_extalloc(ptr - shift, old_size + shift, new_size + shift);
+  new_ptr = falloc_extalloc(ptr, alignment, new_size);
   if ((new_ptr == NULL) && (errno == 0))
     {
-      new_ptr = falloc_malloc(new_size + alignment - 1);
+      new_ptr = falloc_malloc(alignment, new_size);
       if (new_ptr != NULL)
 	{
-	  if ((size_t)new_ptr % alignment)
-	    shift = alignment - ((size_t)new_ptr % alignment);
-	  *ptrshift = shift;
-	  new_ptr = (void*)((char*)new_ptr + shift);
+	  *ptrshift = 0;
 	  if (mode & FALLOC_MEMCPY)
-	    memcpy(new_ptr, ptr, old_size);
+	    memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
 	}
     }
   
@@ -563,24 +694,24 @@ static inline void* falloc_realloc(void* ptr, size_t* ptrshift, size_t alignment
 void* falloc(void* ptr, size_t* ptrshift, size_t alignment,
 	     size_t old_size, size_t new_size, enum falloc_mode mode)
 {
-  /* TODO implement falloc_malloc, falloc_free, and falloc_extalloc */
-  
   size_t shift = 0, _ptrshift = 0;
   void* new_ptr = NULL;
   
   if (mode & (enum falloc_mode)~(FALLOC_CLEAR | FALLOC_INIT | FALLOC_MEMCPY))
     goto invalid;
+  if (alignment & (alignment - 1))
+    goto invalid;
   
   if (new_size && old_size && ptr)
     {
       if ((alignment > 1) && !ptrshift)    goto invalid;
+      shift = ptrshift ? *ptrshift : 0;
       new_ptr = falloc_realloc(ptr, ptrshift ? ptrshift : &_ptrshift,
 			       alignment ? alignment : 1,
-			       old_size, new_size, mode, &shift);
-      shift = ptrshift ? *ptrshift : _ptrshift;
+			       old_size, new_size, mode);
     }
   else if (new_size && (old_size || ptr))  goto invalid;
-  else if (new_size)                       new_ptr = falloc_malloc(new_size);
+  else if (new_size)                       goto allocate;
   else if (old_size && ptr)                goto deallocate;
   else if (old_size || !ptr)               goto return_null;
   else                                     goto invalid;
@@ -590,30 +721,40 @@ void* falloc(void* ptr, size_t* ptrshift, size_t alignment,
       if ((new_ptr != ptr) && (ptr != NULL))
 	{
 	  if (mode & FALLOC_CLEAR)
-	    explicit_bzero(ptr, old_size);
-	  falloc_free(ptr - shift);
+	    __slibc_heap_wipe(ptr, 0, old_size);
+	  falloc_free((char*)ptr - shift, alignment, old_size);
 	}
       if (mode & FALLOC_INIT)
 	{
-	  if (!(mode & FALLOC_MEMCPY))
+	  if (!(mode & FALLOC_MEMCPY) && (new_ptr != ptr))
 	    old_size = 0;
 	  if (new_size > old_size)
-	    bzero(new_ptr + old_size, new_size - old_size);
+	    __slibc_heap_clear(new_ptr, old_size, new_size - old_size);
 	}
     }
   
-  return errno = 0, new_ptr;
-  
+  return new_ptr;
+ 
+ allocate:
+  new_ptr = falloc_malloc(alignment ? alignment : 1, new_size);
+  if (new_ptr == NULL)
+    return NULL;
+  if (ptrshift != NULL)
+    *ptrshift = 0;
+  if (mode & FALLOC_INIT)
+    __slibc_heap_clear(new_ptr, 0, new_size);
+  return new_ptr;
+ 
  deallocate:
-  shift = ptrshift == NULL ? *ptrshift : 0;
   if ((alignment > 1) && (ptrshift == NULL))
     goto invalid;
+  shift = ptrshift != NULL ? *ptrshift : 0;
   if (mode & FALLOC_CLEAR)
-    explicit_bzero(ptr, old_size);
-  falloc_free(ptr - shift);
+    __slibc_heap_wipe(ptr, 0, old_size);
+  falloc_free((char*)ptr - shift, alignment, old_size);
  return_null:
   return errno = 0, NULL;
-  
+ 
  invalid:
   return errno = EINVAL, NULL;
 }
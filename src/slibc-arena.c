@@ -0,0 +1,366 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <slibc-arena.h>
+#include <slibc-alloc.h>
+#include <slibc/internals.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+
+
+
+/**
+ * The alignment of allocations made with `arena_alloc`.
+ */
+#define ALIGNMENT  (__alignof__(max_align_t))
+
+
+
+/**
+ * Allocate a new chunk for an arena, and
+ * make an allocation from it.
+ * 
+ * @param   arena     The arena.
+ * @param   boundary  The alignment of the allocation.
+ * @param   size      The size of the allocation.
+ * @return            The allocation, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+static void* arena_grow(struct arena* arena, size_t boundary, size_t size)
+{
+  struct arena_chunk* chunk;
+  size_t chunk_size, need;
+  char* ptr;
+  
+  /* Allocations that are larger than a chunk get a chunk of their own. */
+  MEM_OVERFLOW(uaddl, size, sizeof(struct arena_chunk) + boundary - 1, &need);
+  chunk_size = arena->chunk_size ? arena->chunk_size : ARENA_CHUNK_SIZE;
+  if (chunk_size < need)
+    chunk_size = need;
+  
+  chunk = malloc(chunk_size);
+  if (chunk == NULL)
+    return NULL;
+  chunk->prev = arena->chunk;
+  chunk->end = (char*)chunk + chunk_size;
+  
+  ptr = (char*)(chunk + 1);
+  ptr = (char*)(((size_t)ptr + (boundary - 1)) & ~(boundary - 1));
+  arena->chunk = chunk;
+  arena->next = ptr + size;
+  arena->end = chunk->end;
+  return ptr;
+}
+
+
+/**
+ * Initialise an arena.
+ * 
+ * No memory is allocated until the first
+ * allocation is made from the arena.
+ * 
+ * @param  arena       The arena.
+ * @param  chunk_size  The size of the chunks the arena
+ *                     shall allocate from the heap,
+ *                     zero for `ARENA_CHUNK_SIZE`.
+ * 
+ * @since  Always.
+ */
+void arena_init(struct arena* arena, size_t chunk_size)
+{
+  arena->chunk = NULL;
+  arena->next = NULL;
+  arena->end = NULL;
+  arena->chunk_size = chunk_size ? chunk_size : ARENA_CHUNK_SIZE;
+}
+
+
+/**
+ * Deallocate all memory allocated from an arena.
+ * 
+ * The arena is left empty, and can be used again.
+ * 
+ * @param  arena  The arena.
+ * 
+ * @since  Always.
+ */
+void arena_free(struct arena* arena)
+{
+  struct arena_savepoint empty = { NULL, NULL };
+  arena_rewind(arena, &empty);
+}
+
+
+/**
+ * Allocate memory from an arena. The returned
+ * pointer has the same alignment as a pointer
+ * returned by `malloc`.
+ * 
+ * @param   arena  The arena.
+ * @param   size   The size of the allocation.
+ * @return         Pointer to the beginning of the new allocation.
+ *                 If `size` is zero, this function will either
+ *                 return `NULL` (that is what this implement does)
+ *                 or return a unique pointer that can later be
+ *                 freed with `arena_free`. Upon error, `NULL`
+ *                 is returned.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* arena_alloc(struct arena* arena, size_t size)
+{
+  return arena_memalign(arena, ALIGNMENT, size);
+}
+
+
+/**
+ * Variant of `arena_alloc` that initialises
+ * the allocated memory with zeroes.
+ * 
+ * @param   arena  The arena.
+ * @param   size   The size of the allocation.
+ * @return         See `arena_alloc`.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* arena_zalloc(struct arena* arena, size_t size)
+{
+  void* ptr = arena_memalign(arena, ALIGNMENT, size);
+  if (ptr != NULL)
+    bzero(ptr, size);
+  return ptr;
+}
+
+
+/**
+ * Allocate memory from an arena, with a specified alignment.
+ * 
+ * @param   arena     The arena.
+ * @param   boundary  The alignment, must be a power of two.
+ * @param   size      The size of the allocation.
+ * @return            See `arena_alloc`.
+ * 
+ * @throws  EINVAL  `boundary` is not a power of two.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* arena_memalign(struct arena* arena, size_t boundary, size_t size)
+{
+  char* ptr;
+  
+  if (!boundary || (boundary & (boundary - 1)))
+    return errno = EINVAL, NULL;
+  if (size == 0)
+    return NULL;
+  
+  ptr = (char*)(((size_t)(arena->next) + (boundary - 1)) & ~(boundary - 1));
+  if ((ptr <= arena->end) && (size <= (size_t)(arena->end - ptr)))
+    return arena->next = ptr + size, ptr;
+  
+  return arena_grow(arena, boundary, size);
+}
+
+
+/**
+ * Save the state of an arena, so that all
+ * allocations made after this call can be
+ * deallocated with `arena_rewind`.
+ * 
+ * @param  arena      The arena.
+ * @param  savepoint  Output parameter for the state.
+ * 
+ * @since  Always.
+ */
+void arena_save(const struct arena* arena, struct arena_savepoint* savepoint)
+{
+  savepoint->chunk = arena->chunk;
+  savepoint->next = arena->next;
+}
+
+
+/**
+ * Deallocate all memory allocated from an arena
+ * since a savepoint was made. Savepoints made
+ * after `savepoint` become invalid.
+ * 
+ * @param  arena      The arena.
+ * @param  savepoint  The state to restore the arena to.
+ * 
+ * @since  Always.
+ */
+void arena_rewind(struct arena* arena, const struct arena_savepoint* savepoint)
+{
+  struct arena_chunk* chunk;
+  
+  while (arena->chunk != savepoint->chunk)
+    {
+      chunk = arena->chunk;
+      arena->chunk = chunk->prev;
+      fast_free(chunk);
+    }
+  
+  arena->next = savepoint->next;
+  arena->end = arena->chunk == NULL ? NULL : arena->chunk->end;
+}
+
+
+/**
+ * Duplicate a memory segment into an arena.
+ * 
+ * @param   arena    The arena.
+ * @param   segment  The memory segment to duplicate.
+ * @param   size     The size of the memory segment.
+ * @return           The new segment. `NULL` is returned on error
+ *                   and `errno` is set to indicate the error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* arena_memdup(struct arena* arena, const void* segment, size_t size)
+{
+  void* r = arena_memalign(arena, ALIGNMENT, size);
+  return r == NULL ? NULL : memcpy(r, segment, size);
+}
+
+
+/**
+ * Duplicate a string into an arena.
+ * 
+ * @param   arena   The arena.
+ * @param   string  The string to duplicate.
+ * @return          The new string. `NULL` is returned on error
+ *                  and `errno` is set to indicate the error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+char* arena_strdup(struct arena* arena, const char* string)
+{
+  size_t n = strlen(string) + 1;
+  char* r = arena_memalign(arena, 1, n * sizeof(char));
+  return r == NULL ? NULL : memcpy(r, string, n * sizeof(char));
+}
+
+
+/**
+ * Duplicate a string into an arena.
+ * 
+ * @param   arena   The arena.
+ * @param   string  The string to duplicate.
+ * @param   maxlen  Truncate the string to this length, if it is longer.
+ *                  A NUL byte is guaranteed to always be written
+ *                  upon successful completion.
+ * @return          The new string. `NULL` is returned on error
+ *                  and `errno` is set to indicate the error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+char* arena_strndup(struct arena* arena, const char* string, size_t maxlen)
+{
+  size_t n = strnlen(string, maxlen);
+  char* r = arena_memalign(arena, 1, (n + 1) * sizeof(char));
+  if (r == NULL)
+    return NULL;
+  memcpy(r, string, n * sizeof(char));
+  r[n] = 0;
+  return r;
+}
+
+
+/**
+ * Format a string into an arena.
+ * 
+ * @param   arena   The arena.
+ * @param   format  The formatting-string, see `printf`.
+ * @param   ...     The formatting-arguments.
+ * @return          The new string. `NULL` is returned on error
+ *                  and `errno` is set to indicate the error.
+ * 
+ * @throws  EINVAL  `format` contained unsupported formatting codes.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+char* arena_asprintf(struct arena* arena, const char* format, ...)
+{
+  char* r;
+  va_list args;
+  va_start(args, format);
+  r = arena_vasprintf(arena, format, args);
+  va_end(args);
+  return r;
+}
+
+
+/**
+ * This function is identical to `arena_asprintf`,
+ * except it uses `va_list` instead of variadic arguments.
+ * 
+ * @param   arena   The arena.
+ * @param   format  The formatting-string, see `printf`.
+ * @param   args    The formatting-arguments.
+ * @return          The new string. `NULL` is returned on error
+ *                  and `errno` is set to indicate the error.
+ * 
+ * @throws  EINVAL  `format` contained unsupported formatting codes.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+char* arena_vasprintf(struct arena* arena, const char* format, va_list args)
+{
+  size_t room = (size_t)(arena->end - arena->next);
+  va_list args_copy;
+  char* r;
+  int n;
+  
+  /* Format directly into the current chunk, and only
+   * format a second time if the string did not fit. */
+  va_copy(args_copy, args);
+  n = vsnprintf(arena->next, room, format, args_copy);
+  va_end(args_copy);
+  if (n < 0)
+    return NULL;
+  if ((size_t)n < room)
+    {
+      r = arena->next;
+      arena->next += (size_t)n + 1;
+      return r;
+    }
+  
+  r = arena_memalign(arena, 1, ((size_t)n + 1) * sizeof(char));
+  if (r == NULL)
+    return NULL;
+  vsnprintf(r, (size_t)n + 1, format, args);
+  return r;
+}
+
@@ -0,0 +1,391 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <slibc-pool.h>
+#include <stddef.h>
+#include <strings.h>
+#include <errno.h>
+#include "malloc/heap.h"
+
+
+
+/**
+ * The greatest default alignment of objects.
+ */
+#define ALIGNMENT  (__alignof__(max_align_t))
+
+/**
+ * The number of magazines in a pool. Threads are
+ * assigned a magazine each, round-robin.
+ */
+#define MAGAZINES  16
+
+/**
+ * The maximum number of objects in a magazine.
+ * Half as many objects are moved at a time
+ * between a magazine and its pool.
+ */
+#define MAGAZINE_SIZE  32
+
+
+/**
+ * Lock a pool, if it can be used
+ * by multiple threads.
+ * 
+ * @param  pool  The pool.
+ */
+#define POOL_LOCK(pool)			\
+  do					\
+    if ((pool)->flags)			\
+      HEAP_LOCK((pool)->lock);		\
+  while (0)
+
+/**
+ * Unlock a pool locked with `POOL_LOCK`.
+ * 
+ * @param  pool  The pool.
+ */
+#define POOL_UNLOCK(pool)		\
+  do					\
+    if ((pool)->flags)			\
+      HEAP_UNLOCK((pool)->lock);	\
+  while (0)
+
+
+
+/**
+ * A cache of free objects of a pool, used by a thread.
+ * Each magazine is on a cache line of its own.
+ */
+struct pool_magazine
+{
+  /**
+   * Lock for the magazine. It is only contended
+   * if multiple threads are assigned the same magazine.
+   */
+  heap_lock_t lock;
+  
+  /**
+   * Linked list of the objects in the magazine.
+   */
+  void* head;
+  
+  /**
+   * The number of objects in `head`.
+   */
+  size_t count;
+  
+} __GCC_ONLY(__attribute__((__aligned__(64))));
+
+
+
+/**
+ * The number of threads that have been assigned a magazine.
+ */
+static size_t thread_count = 0;
+
+/**
+ * The calling thread's magazine, plus one,
+ * zero if it has not been assigned one.
+ */
+static __thread size_t thread_magazine = 0;
+
+
+
+/**
+ * Take an object from a pool, which must be locked.
+ * 
+ * @param   pool  The pool.
+ * @return        The object, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ */
+static void* pool_take(struct pool* pool)
+{
+  void* obj = pool->free;
+  char* slab;
+  
+  if (obj != NULL)
+    return pool->free = *(void**)obj, obj;
+  
+  if ((size_t)(pool->end - pool->next) < pool->size)
+    {
+      slab = __slibc_heap_span_get();
+      if (slab == NULL)
+	return NULL;
+      *(void**)(void*)slab = pool->slabs;
+      pool->slabs = slab;
+      pool->next = (char*)(((size_t)slab + sizeof(void*) + pool->alignment - 1) & ~(pool->alignment - 1));
+      pool->end = slab + HEAP_SPAN_SIZE;
+    }
+  
+  obj = pool->next;
+  pool->next += pool->size;
+  return obj;
+}
+
+
+/**
+ * Return an object to a pool, which must be locked.
+ * 
+ * @param  pool  The pool.
+ * @param  obj   The object.
+ */
+static inline void pool_give(struct pool* pool, void* obj)
+{
+  *(void**)obj = pool->free;
+  pool->free = obj;
+}
+
+
+/**
+ * Get and lock the calling thread's magazine of a pool.
+ * 
+ * @param   pool  The pool.
+ * @return        The magazine, `NULL` if the pool does not
+ *                have magazines or if the magazine is in use.
+ */
+static struct pool_magazine* magazine_get(struct pool* pool)
+{
+  struct pool_magazine* mag;
+  
+  if (pool->magazines == NULL)
+    return NULL;
+  
+  if (thread_magazine == 0)
+    thread_magazine = __atomic_add_fetch(&thread_count, 1, __ATOMIC_RELAXED);
+  mag = (struct pool_magazine*)(pool->magazines) + (thread_magazine - 1) % MAGAZINES;
+  
+  if (__atomic_test_and_set(&(mag->lock), __ATOMIC_ACQUIRE))
+    return NULL;
+  return mag;
+}
+
+
+
+/**
+ * Initialise a pool.
+ * 
+ * No memory is allocated until the first object
+ * is allocated from the pool, unless `POOL_MAGAZINES`
+ * is used.
+ * 
+ * @param   pool       The pool.
+ * @param   size       The size of the objects.
+ * @param   alignment  The alignment of the objects, must be a
+ *                     power of two, zero for the greatest
+ *                     alignment an object of `size` bytes can
+ *                     require, but at most that of `malloc`.
+ * @param   flags      `POOL_LOCKED`, `POOL_MAGAZINES`, both, or neither.
+ * @return             Zero on success, -1 on error.
+ * 
+ * @throws  EINVAL  `size` is zero or greater than `POOL_OBJECT_MAX`,
+ *                  `alignment` is not a power of two or zero, or
+ *                  is greater than `POOL_OBJECT_MAX`, or `flags`
+ *                  is invalid.
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+int pool_init(struct pool* pool, size_t size, size_t alignment, enum pool_flags flags)
+{
+  char* slab;
+  
+  /* An object's alignment divides its size, so by default,
+   * objects are packed without padding, e.g. 24-byte objects
+   * are aligned to 8 bytes, rather than padded to 32 bytes. */
+  if (alignment == 0)
+    alignment = (size & -size) < ALIGNMENT ? (size & -size) : ALIGNMENT;
+  if (!size || (size > POOL_OBJECT_MAX) || (alignment & (alignment - 1)) ||
+      (alignment > POOL_OBJECT_MAX) || ((unsigned)flags > (POOL_LOCKED | POOL_MAGAZINES)))
+    return errno = EINVAL, -1;
+  
+  /* Free objects hold the link to the next free object. */
+  if (alignment < __alignof__(void*))
+    alignment = __alignof__(void*);
+  if (size < sizeof(void*))
+    size = sizeof(void*);
+  
+  pool->free      = NULL;
+  pool->next      = NULL;
+  pool->end       = NULL;
+  pool->slabs     = NULL;
+  pool->size      = (size + alignment - 1) & ~(alignment - 1);
+  pool->alignment = alignment;
+  pool->magazines = NULL;
+  pool->flags     = flags;
+  pool->lock      = 0;
+  
+  if (!(flags & POOL_MAGAZINES))
+    return 0;
+  
+  /* The magazines are stored at the beginning
+   * of the first slab, so that they are
+   * released with it by `pool_destroy`. */
+  slab = __slibc_heap_span_get();
+  if (slab == NULL)
+    return -1;
+  *(void**)(void*)slab = NULL;
+  pool->slabs = slab;
+  pool->magazines = slab + sizeof(struct pool_magazine);
+  bzero(pool->magazines, MAGAZINES * sizeof(struct pool_magazine));
+  slab += (MAGAZINES + 1) * sizeof(struct pool_magazine);
+  pool->next = (char*)(((size_t)slab + alignment - 1) & ~(alignment - 1));
+  pool->end = (char*)(pool->slabs) + HEAP_SPAN_SIZE;
+  return 0;
+}
+
+
+/**
+ * Deallocate all objects in a pool, and all memory the
+ * pool uses. The pool must be initialised again before
+ * it is reused. The pool must not be used by any other
+ * thread when this function is called.
+ * 
+ * @param  pool  The pool.
+ * 
+ * @since  Always.
+ */
+void pool_destroy(struct pool* pool)
+{
+  void* slab;
+  
+  while ((slab = pool->slabs) != NULL)
+    {
+      pool->slabs = *(void**)slab;
+      __slibc_heap_span_put(slab);
+    }
+  
+  pool->free = NULL;
+  pool->next = NULL;
+  pool->end = NULL;
+  pool->magazines = NULL;
+}
+
+
+/**
+ * Allocate an object from a pool.
+ * 
+ * @param   pool  The pool.
+ * @return        The object, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* pool_alloc(struct pool* pool)
+{
+  struct pool_magazine* mag = magazine_get(pool);
+  void* obj;
+  size_t i;
+  
+  if (mag == NULL)
+    {
+      POOL_LOCK(pool);
+      obj = pool_take(pool);
+      POOL_UNLOCK(pool);
+      return obj;
+    }
+  
+  if (mag->head == NULL)
+    {
+      HEAP_LOCK(pool->lock);
+      for (i = 0; i < MAGAZINE_SIZE / 2; i++)
+	{
+	  obj = pool_take(pool);
+	  if (obj == NULL)
+	    break;
+	  *(void**)obj = mag->head;
+	  mag->head = obj;
+	}
+      HEAP_UNLOCK(pool->lock);
+      mag->count = i;
+      if (i == 0)
+	{
+	  HEAP_UNLOCK(mag->lock);
+	  return NULL;
+	}
+    }
+  
+  obj = mag->head;
+  mag->head = *(void**)obj;
+  mag->count -= 1;
+  HEAP_UNLOCK(mag->lock);
+  return obj;
+}
+
+
+/**
+ * Variant of `pool_alloc` that initialises
+ * the object with zeroes.
+ * 
+ * @param   pool  The pool.
+ * @return        The object, `NULL` on error.
+ * 
+ * @throws  ENOMEM  The process cannot allocate more memory.
+ * 
+ * @since  Always.
+ */
+void* pool_zalloc(struct pool* pool)
+{
+  void* obj = pool_alloc(pool);
+  if (obj != NULL)
+    bzero(obj, pool->size);
+  return obj;
+}
+
+
+/**
+ * Return an object to the pool it was allocated from.
+ * 
+ * @param  pool  The pool.
+ * @param  obj   The object, `NULL` is ignored.
+ * 
+ * @since  Always.
+ */
+void pool_free(struct pool* pool, void* obj)
+{
+  struct pool_magazine* mag;
+  
+  if (obj == NULL)
+    return;
+  
+  mag = magazine_get(pool);
+  if (mag == NULL)
+    {
+      POOL_LOCK(pool);
+      pool_give(pool, obj);
+      POOL_UNLOCK(pool);
+      return;
+    }
+  
+  *(void**)obj = mag->head;
+  mag->head = obj;
+  if (++(mag->count) > MAGAZINE_SIZE)
+    {
+      HEAP_LOCK(pool->lock);
+      for (; mag->count > MAGAZINE_SIZE / 2; mag->count--)
+	{
+	  obj = mag->head;
+	  mag->head = *(void**)obj;
+	  pool_give(pool, obj);
+	}
+      HEAP_UNLOCK(pool->lock);
+    }
+  HEAP_UNLOCK(mag->lock);
+}
+
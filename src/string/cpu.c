@@ -0,0 +1,182 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stddef.h>
+#include "cpu.h"
+
+
+
+/**
+ * The process's environment variables.
+ */
+extern char** environ;
+
+
+/**
+ * The names of the features in `SLIBC_CPU_FEATURES`.
+ */
+static const struct
+{
+  const char* name;
+  int feature;
+} feature_names[] =
+  {
+    { "sse2",      CPU_SSE2     },
+    { "avx2",      CPU_AVX2     },
+    { "avx512bw",  CPU_AVX512BW },
+  };
+
+
+/**
+ * The available features, -1 if they
+ * have not been detected yet.
+ */
+static int cpu_features = -1;
+
+
+
+/**
+ * Detect the features of the CPU.
+ * 
+ * @return  The features of the CPU.
+ */
+static int cpu_detect(void)
+{
+  int features = 0;
+#if defined(__x86_64__) || defined(__i386__)
+  /* This also checks that the operating system
+   * saves the registers the features use. */
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("sse2"))
+    features |= CPU_SSE2;
+  if (__builtin_cpu_supports("avx2"))
+    features |= CPU_AVX2;
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+    features |= CPU_AVX512BW;
+#endif
+  return features;
+}
+
+
+/**
+ * Check whether a string begins with a prefix.
+ * 
+ * This, rather than `strncmp`, is used because the features
+ * are needed to resolve the kernels of the string functions,
+ * so no string function may be called before they are known.
+ * 
+ * @param   string  The string.
+ * @param   prefix  The prefix.
+ * @return          The rest of `string`, `NULL` if it
+ *                  does not begin with `prefix`.
+ */
+__GCC_ONLY(__attribute__((__pure__)))
+static const char* cpu_skip_prefix(const char* string, const char* prefix)
+{
+  while (*prefix)
+    if (*string++ != *prefix++)
+      return NULL;
+  return string;
+}
+
+
+/**
+ * Get the value of `SLIBC_CPU_FEATURES`, without `getenv`,
+ * which calls string functions, see `cpu_skip_prefix`.
+ * 
+ * @return  The value, `NULL` if the variable is not set.
+ */
+__GCC_ONLY(__attribute__((__pure__)))
+static const char* cpu_getenv(void)
+{
+  const char* value;
+  size_t i;
+  
+  if (environ == NULL)
+    return NULL;
+  for (i = 0; environ[i] != NULL; i++)
+    if ((value = cpu_skip_prefix(environ[i], "SLIBC_CPU_FEATURES=")))
+      return value;
+  return NULL;
+}
+
+
+/**
+ * Get the features listed in `SLIBC_CPU_FEATURES`.
+ * Unrecognised names are ignored.
+ * 
+ * @param   list  The value of `SLIBC_CPU_FEATURES`.
+ * @return        The listed features.
+ */
+__GCC_ONLY(__attribute__((__pure__)))
+static int cpu_parse(const char* list)
+{
+  int features = 0;
+  const char* name;
+  const char* rest;
+  size_t i;
+  
+  while (*list)
+    {
+      name = list;
+      while (*list && (*list != ','))
+	list++;
+      
+      for (i = 0; i < sizeof(feature_names) / sizeof(*feature_names); i++)
+	if ((rest = cpu_skip_prefix(name, feature_names[i].name)) && (rest == list))
+	  features |= feature_names[i].feature;
+      
+      if (*list)
+	list++;
+    }
+  
+  return features;
+}
+
+
+/**
+ * Get the CPU features that kernels may use.
+ * 
+ * The features are detected on the first call. If the
+ * environment variable `SLIBC_CPU_FEATURES` is set, only
+ * the features it lists, as comma-separated names, may
+ * be used. This is intended for benchmarking the
+ * kernels against each other. The names are `sse2`,
+ * `avx2`, and `avx512bw`; if it is empty, only the
+ * portable kernels are used.
+ * 
+ * @return  The available features, a combination of
+ *          `CPU_SSE2`, `CPU_AVX2`, and `CPU_AVX512BW`.
+ */
+int __slibc_cpu_features(void)
+{
+  int features = __atomic_load_n(&cpu_features, __ATOMIC_RELAXED);
+  const char* list;
+  
+  /* Threads that race here detect the same features. */
+  if (features < 0)
+    {
+      features = cpu_detect();
+      list = cpu_getenv();
+      if (list != NULL)
+	features &= cpu_parse(list);
+      __atomic_store_n(&cpu_features, features, __ATOMIC_RELAXED);
+    }
+  
+  return features;
+}
+
@@ -0,0 +1,250 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+/* This file is intended to be included by the string functions
+ * that have kernels specialised for features that not every CPU
+ * has, and by nothing else.
+ * 
+ * Each such function has a registry, an array of its kernels
+ * ordered from the most to the least preferred, each with the
+ * CPU features it requires. The last kernel is portable and
+ * requires nothing. The function calls its kernel through a
+ * pointer, which initially points to a resolver. On the first
+ * call, the resolver selects the first kernel whose features
+ * are available, stores it in the pointer, and calls it. Thus
+ * the kernel is selected once per process, and this works in
+ * static and shared builds alike, without `ifunc` support in
+ * the linker. */
+#include <stddef.h>
+#include <stdint.h>
+
+
+
+/**
+ * SSE2 is available.
+ */
+#define CPU_SSE2  0x0001
+
+/**
+ * AVX2 is available, and the operating
+ * system saves the AVX registers.
+ */
+#define CPU_AVX2  0x0002
+
+/**
+ * AVX-512 Foundation and Byte and Word
+ * instructions are available, and the
+ * operating system saves the AVX-512 registers.
+ */
+#define CPU_AVX512BW  0x0004
+
+
+
+/**
+ * Copies and fills that are at least this large
+ * are made with non-temporal stores, so that they
+ * do not evict the rest of the cache.
+ */
+#define CPU_NONTEMPORAL_MIN  ((size_t)4 << 20)
+
+
+
+/**
+ * Integers and vectors that may be unaligned,
+ * and may alias any other type, for loading
+ * and storing memory in the kernels.
+ */
+typedef uint16_t cpu_u16_t __attribute__((__may_alias__, __aligned__(1)));
+typedef uint32_t cpu_u32_t __attribute__((__may_alias__, __aligned__(1)));
+typedef uint64_t cpu_u64_t __attribute__((__may_alias__, __aligned__(1)));
+typedef size_t cpu_word_t __attribute__((__may_alias__, __aligned__(1)));
+typedef long long int cpu_vec16_t __attribute__((__vector_size__(16), __may_alias__, __aligned__(1)));
+typedef long long int cpu_vec32_t __attribute__((__vector_size__(32), __may_alias__, __aligned__(1)));
+
+/**
+ * Aligned words and vectors of bytes, that
+ * may alias any other type, for scanning
+ * memory with aligned loads.
+ */
+typedef size_t cpu_aword_t __attribute__((__may_alias__));
+typedef char cpu_bytes16_t __attribute__((__vector_size__(16), __may_alias__));
+typedef char cpu_bytes32_t __attribute__((__vector_size__(32), __may_alias__));
+
+
+/**
+ * A word with the byte 1 in every byte.
+ */
+#define CPU_ONES  ((size_t)-1 / 0xFF)
+
+/**
+ * Make a word with a byte repeated in it.
+ * 
+ * @param   c  The byte.
+ * @return     The word.
+ */
+#define CPU_SPLAT_WORD(c)  (CPU_ONES * (unsigned char)(c))
+
+/**
+ * Make the mask of the zero bytes in a word, the
+ * highest bit of each zero byte is set. Unlike the
+ * shorter `(w - ONES) & ~w & (ONES << 7)`, this is
+ * exact for every byte, not just the first zero byte.
+ * 
+ * @param   w  The word.
+ * @return     The mask of zero bytes in `w`.
+ */
+#define CPU_ZEROS(w)  (~((((w) & ~(CPU_ONES << 7)) + ~(CPU_ONES << 7)) | (w)) & (CPU_ONES << 7))
+
+/**
+ * Make a vector with a byte repeated in it.
+ * 
+ * @param   c  The byte.
+ * @return     The vector.
+ */
+#define CPU_SPLAT_BYTES16(c)  ((cpu_bytes16_t){ 0 } + (char)(c))
+#define CPU_SPLAT_BYTES32(c)  ((cpu_bytes32_t){ 0 } + (char)(c))
+
+/**
+ * Make a mask, with one bit per byte, of the bytes
+ * whose highest bit is set in a vector. Requires
+ * SSE2 and AVX2, respectively.
+ * 
+ * @param   v  The vector, typically the result of a comparison.
+ * @return     The mask, as an `unsigned int`.
+ */
+#define CPU_MOVEMASK16(v)  ((unsigned)__builtin_ia32_pmovmskb128((cpu_bytes16_t)(v)))
+#define CPU_MOVEMASK32(v)  ((unsigned)__builtin_ia32_pmovmskb256((cpu_bytes32_t)(v)))
+
+
+
+/**
+ * Define the pointer through which a function calls
+ * its kernel, and the resolver that it initially
+ * points to. The registry must be named `NAME##_kernels`,
+ * and be an array of structures with the members
+ * `int features` and `RET (*kernel) PARAMS`. The
+ * pointer is named `NAME##_kernel`, and is global so
+ * that other functions can share the kernels; thus
+ * `NAME` shall begin with `__slibc_`.
+ * 
+ * @param  RET     The return type of the function.
+ * @param  NAME    The name of the function.
+ * @param  PARAMS  The parameter list of the function, in parentheses.
+ * @param  ARGS    The names of the parameters, in parentheses.
+ */
+#define CPU_DISPATCH(RET, NAME, PARAMS, ARGS)					\
+  static RET NAME##_resolve PARAMS;						\
+  RET (*NAME##_kernel) PARAMS = NAME##_resolve;					\
+  static RET NAME##_resolve PARAMS						\
+  {										\
+    int features = __slibc_cpu_features();					\
+    size_t i = 0;								\
+    while (NAME##_kernels[i].features & ~features)				\
+      i++;									\
+    __atomic_store_n(&NAME##_kernel, NAME##_kernels[i].kernel, __ATOMIC_RELAXED); \
+    return NAME##_kernels[i].kernel ARGS;					\
+  }
+
+
+
+/**
+ * Get the CPU features that kernels may use.
+ * 
+ * The features are detected on the first call. If the
+ * environment variable `SLIBC_CPU_FEATURES` is set, only
+ * the features it lists, as comma-separated names, may
+ * be used. This is intended for benchmarking the
+ * kernels against each other. The names are `sse2`,
+ * `avx2`, and `avx512bw`; if it is empty, only the
+ * portable kernels are used.
+ * 
+ * @return  The available features, a combination of
+ *          `CPU_SSE2`, `CPU_AVX2`, and `CPU_AVX512BW`.
+ */
+int __slibc_cpu_features(void)
+  __GCC_ONLY(__attribute__((__warn_unused_result__)));
+
+
+/**
+ * Copy a memory segment to another, possibly overlapping,
+ * segment, with the best kernel for the CPU.
+ * 
+ * @param   whither  The destination memory segment.
+ * @param   whence   The source memory segment.
+ * @param   size     The number of bytes to copy.
+ * @return           `whither` is returned.
+ */
+extern void* (*__slibc_memmove_kernel)(void*, const void*, size_t);
+
+/**
+ * Override a memory segment with a repeated 32-bit
+ * pattern, with the best kernel for the CPU.
+ * 
+ * Unless all bytes of `pattern` are equal, `segment`
+ * must be aligned to 4 bytes, and `size` must be a
+ * multiple of 4.
+ * 
+ * @param   segment  The beginning of the memory segment.
+ * @param   pattern  The pattern, in the byte order of the CPU.
+ * @param   size     The size of the memory segment, in bytes.
+ * @return           `segment` is returned.
+ */
+extern void* (*__slibc_fill_kernel)(void*, uint32_t, size_t);
+
+/**
+ * Find the first byte, among the first `size` bytes of
+ * a memory segment, that is equal to either of two bytes,
+ * with the best kernel for the CPU. Bytes up to the next
+ * aligned address may be read, so the segment need only
+ * be readable up to the sought after byte.
+ * 
+ * @param   s     The memory segment.
+ * @param   c1    One of the sought after bytes.
+ * @param   c2    The other sought after byte,
+ *                equal to `c1` to seek only one byte.
+ * @param   size  The number of bytes to search,
+ *                `SIZE_MAX` if the search is unbounded.
+ * @return        The first occurrence of `c1` or `c2`,
+ *                `NULL` if none was found.
+ */
+extern const char* (*__slibc_scan_kernel)(const char*, int, int, size_t);
+
+/**
+ * Find the last byte, among the first `size` bytes of
+ * a memory segment, that is equal to a byte, with the
+ * best kernel for the CPU.
+ * 
+ * @param   s     The memory segment.
+ * @param   c     The sought after byte.
+ * @param   size  The number of bytes to search.
+ * @return        The last occurrence of `c`,
+ *                `NULL` if none was found.
+ */
+extern const char* (*__slibc_rscan_kernel)(const char*, int, size_t);
+
+/**
+ * Find the last occurrence of a byte in a string,
+ * in one pass, with the best kernel for the CPU.
+ * 
+ * @param   s  The string, the terminating NUL
+ *             byte is a part of the string.
+ * @param   c  The sought after byte.
+ * @return     The last occurrence of `c`,
+ *             `NULL` if none was found.
+ */
+extern const char* (*__slibc_strrchr_kernel)(const char*, int);
+
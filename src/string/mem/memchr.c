@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
 
 
 # pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
@@ -35,10 +36,6 @@
  */
 void* (memchr)(const void* segment, int c, size_t size)
 {
-  char* s = segment;
-  while (size--)
-    if (*s++ == c)
-      return s - 1;
-  return NULL;
+  return __slibc_scan_kernel(segment, c, c, size);
 }
 
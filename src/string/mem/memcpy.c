@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
 
 
 
@@ -31,10 +32,6 @@
  */
 void* memcpy(void* restrict whither, const void* restrict whence, size_t size)
 {
-  char* d = whither;
-  const char* s = whence;
-  while (size--)
-    *d++ = *s++;
-  return whither;
+  return __slibc_memmove_kernel(whither, whence, size);
 }
 
@@ -16,6 +16,193 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
+
+
+
+/**
+ * Copy less than 32 bytes. All bytes are loaded
+ * before any is stored, so the segments may overlap.
+ * 
+ * @param  d     The destination memory segment.
+ * @param  s     The source memory segment.
+ * @param  size  The number of bytes to copy, less than 32.
+ */
+__GCC_ONLY(__attribute__((__always_inline__)))
+static inline void copy_small(char* d, const char* s, size_t size)
+{
+  /* Two possibly overlapping loads cover every size
+   * from a power of two up to twice that size. */
+  if (size >= 16)
+    {
+      cpu_vec16_t a = *(const cpu_vec16_t*)s, b = *(const cpu_vec16_t*)(s + size - 16);
+      *(cpu_vec16_t*)d = a, *(cpu_vec16_t*)(d + size - 16) = b;
+    }
+  else if (size >= 8)
+    {
+      uint64_t a = *(const cpu_u64_t*)s, b = *(const cpu_u64_t*)(s + size - 8);
+      *(cpu_u64_t*)d = a, *(cpu_u64_t*)(d + size - 8) = b;
+    }
+  else if (size >= 4)
+    {
+      uint32_t a = *(const cpu_u32_t*)s, b = *(const cpu_u32_t*)(s + size - 4);
+      *(cpu_u32_t*)d = a, *(cpu_u32_t*)(d + size - 4) = b;
+    }
+  else if (size >= 2)
+    {
+      uint16_t a = *(const cpu_u16_t*)s, b = *(const cpu_u16_t*)(s + size - 2);
+      *(cpu_u16_t*)d = a, *(cpu_u16_t*)(d + size - 2) = b;
+    }
+  else if (size)
+    *d = *s;
+}
+
+
+/**
+ * Define a copy kernel that uses units of the type `VEC`.
+ * 
+ * Less than two units are copied with overlapping loads.
+ * Otherwise, the first and last unit are loaded first and
+ * stored last, so that the units in between can be stored
+ * at aligned addresses, four at a time. Copies where the
+ * destination comes after an overlapping source are made
+ * backwards.
+ * 
+ * @param  NAME    The name of the kernel.
+ * @param  VEC     The type of the units.
+ * @param  STREAM  Function-like macro that stores a unit at
+ *                 an aligned address, with a non-temporal
+ *                 store if there is one.
+ * @param  FENCE   Statement that orders the non-temporal
+ *                 stores before later stores.
+ */
+#define COPY_KERNEL(NAME, VEC, STREAM, FENCE)						\
+  static void* NAME(void* whither, const void* whence, size_t size)			\
+  {											\
+    const size_t n = sizeof(VEC);							\
+    char* d = whither;									\
+    const char* s = whence;								\
+    VEC head, tail, v[4];								\
+    size_t i;										\
+											\
+    if (size < n)									\
+      return copy_small(d, s, size), whither;						\
+    head = *(const VEC*)s;								\
+    tail = *(const VEC*)(s + size - n);							\
+    if (size <= 2 * n)									\
+      goto out;										\
+											\
+    if ((size_t)(d - s) >= size)							\
+      {											\
+	i = n - ((size_t)d & (n - 1));							\
+	if ((size >= CPU_NONTEMPORAL_MIN) && ((size_t)(s - d) >= size))			\
+	  {										\
+	    for (; size - i > 4 * n; i += 4 * n)					\
+	      {										\
+		v[0] = *(const VEC*)(s + i + 0 * n);					\
+		v[1] = *(const VEC*)(s + i + 1 * n);					\
+		v[2] = *(const VEC*)(s + i + 2 * n);					\
+		v[3] = *(const VEC*)(s + i + 3 * n);					\
+		STREAM(d + i + 0 * n, v[0]);						\
+		STREAM(d + i + 1 * n, v[1]);						\
+		STREAM(d + i + 2 * n, v[2]);						\
+		STREAM(d + i + 3 * n, v[3]);						\
+	      }										\
+	    FENCE;									\
+	  }										\
+	for (; size - i > 4 * n; i += 4 * n)						\
+	  {										\
+	    v[0] = *(const VEC*)(s + i + 0 * n);					\
+	    v[1] = *(const VEC*)(s + i + 1 * n);					\
+	    v[2] = *(const VEC*)(s + i + 2 * n);					\
+	    v[3] = *(const VEC*)(s + i + 3 * n);					\
+	    *(VEC*)(d + i + 0 * n) = v[0];						\
+	    *(VEC*)(d + i + 1 * n) = v[1];						\
+	    *(VEC*)(d + i + 2 * n) = v[2];						\
+	    *(VEC*)(d + i + 3 * n) = v[3];						\
+	  }										\
+	for (; size - i > n; i += n)							\
+	  *(VEC*)(d + i) = *(const VEC*)(s + i);					\
+      }											\
+    else										\
+      {											\
+	i = size - ((size_t)(d + size) & (n - 1));					\
+	for (; i > 4 * n; i -= 4 * n)							\
+	  {										\
+	    v[3] = *(const VEC*)(s + i - 1 * n);					\
+	    v[2] = *(const VEC*)(s + i - 2 * n);					\
+	    v[1] = *(const VEC*)(s + i - 3 * n);					\
+	    v[0] = *(const VEC*)(s + i - 4 * n);					\
+	    *(VEC*)(d + i - 1 * n) = v[3];						\
+	    *(VEC*)(d + i - 2 * n) = v[2];						\
+	    *(VEC*)(d + i - 3 * n) = v[1];						\
+	    *(VEC*)(d + i - 4 * n) = v[0];						\
+	  }										\
+	for (; i > n; i -= n)								\
+	  *(VEC*)(d + i - n) = *(const VEC*)(s + i - n);				\
+      }											\
+											\
+  out:											\
+    *(VEC*)d = head;									\
+    *(VEC*)(d + size - n) = tail;							\
+    return whither;									\
+  }
+
+
+/**
+ * Store a word, there are no portable non-temporal stores.
+ * 
+ * @param  p  The address.
+ * @param  v  The word.
+ */
+#define STORE_WORD(p, v)  (*(cpu_word_t*)(p) = (v))
+
+COPY_KERNEL(copy_portable, cpu_word_t, STORE_WORD, (void)0)
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * Aligned vectors, for non-temporal stores.
+ */
+typedef long long int v2di_t __attribute__((__vector_size__(16)));
+typedef long long int v4di_t __attribute__((__vector_size__(32)));
+
+/**
+ * Store a vector with a non-temporal store.
+ * 
+ * @param  p  The address, aligned to the size of the vector.
+ * @param  v  The vector.
+ */
+#define STREAM_VEC16(p, v)  __builtin_ia32_movntdq((v2di_t*)(void*)(p), (v))
+#define STREAM_VEC32(p, v)  __builtin_ia32_movntdq256((v4di_t*)(void*)(p), (v))
+
+__attribute__((__target__("sse2")))
+COPY_KERNEL(copy_sse2, cpu_vec16_t, STREAM_VEC16, __builtin_ia32_sfence())
+
+__attribute__((__target__("avx2")))
+COPY_KERNEL(copy_avx2, cpu_vec32_t, STREAM_VEC32, __builtin_ia32_sfence())
+
+#endif
+
+
+/**
+ * The copy kernels, the most preferred first.
+ */
+static const struct
+{
+  int features;
+  void* (*kernel)(void*, const void*, size_t);
+} __slibc_memmove_kernels[] =
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    { CPU_AVX2, copy_avx2 },
+    { CPU_SSE2, copy_sse2 },
+#endif
+    { 0,        copy_portable },
+  };
+
+CPU_DISPATCH(void*, __slibc_memmove, (void* whither, const void* whence, size_t size), (whither, whence, size))
 
 
 
@@ -31,14 +218,6 @@
  */
 void* memmove(void* whither, const void* whence, size_t size)
 {
-  char* d = whither;
-  const char* s = whence;
-  if ((size_t)(d - s) < size)
-    while (size--)
-      d[size] = s[size];
-  else
-    while (size--)
-      *d++ = *s++;
-  return whither;
+  return __slibc_memmove_kernel(whither, whence, size);
 }
 
@@ -16,12 +16,142 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
 
 
 # pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
 
 
 
+/**
+ * Define a reverse scan kernel that loads units of the type `VEC`.
+ * 
+ * The units are loaded from aligned addresses, so a load never
+ * crosses into another page, even if it reads outside the
+ * memory segment. Units that are entirely in the memory
+ * segment, and aligned four together, are loaded four at a time.
+ * 
+ * @param  NAME   The name of the kernel.
+ * @param  VEC    The type of the units.
+ * @param  MASK   The type of the masks of matching bytes.
+ * @param  SPLAT  Function-like macro that makes a unit with
+ *                a byte repeated in it.
+ * @param  MATCH  Function-like macro that makes the mask of the
+ *                bytes in the unit `v` that are equal to the
+ *                bytes in the unit `x`.
+ * @param  SKIP   Function-like macro that removes the first
+ *                `k` bytes from the mask `m`.
+ * @param  KEEP   Function-like macro that removes all but the
+ *                first `k` bytes, `k` is positive, from the
+ *                mask `m`.
+ * @param  LAST   Function-like macro that gets the index of
+ *                the last byte in the non-zero mask `m`.
+ */
+#define RSCAN_KERNEL(NAME, VEC, MASK, SPLAT, MATCH, SKIP, KEEP, LAST)			\
+  __GCC_ONLY(__attribute__((__pure__)))							\
+  static const char* NAME(const char* s, int c, size_t size)				\
+  {											\
+    const size_t n = sizeof(VEC);							\
+    const char* a;									\
+    VEC x = SPLAT(c);									\
+    MASK m, m1, m2, m3;									\
+											\
+    if (!size)										\
+      return NULL;									\
+    a = s + size - 1;									\
+    a -= (size_t)a & (n - 1);								\
+    m = KEEP(MATCH(*(const VEC*)a, x), (size_t)(s + size - a));				\
+											\
+    /* `m` is always the mask of the unit at `a`. */					\
+    while (a > s)									\
+      {											\
+	if (m)										\
+	  return a + LAST(m);								\
+	if (!((size_t)a & (4 * n - 1)) && ((size_t)(a - s) >= 4 * n))			\
+	  {										\
+	    a -= 4 * n;									\
+	    m3 = MATCH(((const VEC*)a)[3], x);						\
+	    m2 = MATCH(((const VEC*)a)[2], x);						\
+	    m1 = MATCH(((const VEC*)a)[1], x);						\
+	    m  = MATCH(((const VEC*)a)[0], x);						\
+	    if (m3)									\
+	      return a + 3 * n + LAST(m3);						\
+	    if (m2)									\
+	      return a + 2 * n + LAST(m2);						\
+	    if (m1)									\
+	      return a + 1 * n + LAST(m1);						\
+	    continue;									\
+	  }										\
+	a -= n;										\
+	m = MATCH(*(const VEC*)a, x);							\
+      }											\
+											\
+    m = SKIP(m, (size_t)(s - a));							\
+    return m ? a + LAST(m) : NULL;							\
+  }
+
+
+/**
+ * Macros for word kernels, see `RSCAN_KERNEL`.
+ */
+#define SPLAT_WORD(c)     CPU_SPLAT_WORD(c)
+#define MATCH_WORD(v, x)  CPU_ZEROS((v) ^ (x))
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+# define SKIP_WORD(m, k)  ((m) & ((size_t)-1 >> ((k) * 8)))
+# define KEEP_WORD(m, k)  ((m) & ((size_t)-1 << ((sizeof(size_t) - (k)) * 8)))
+# define LAST_WORD(m)     (sizeof(size_t) - 1 - (size_t)__builtin_ctzll(m) / 8)
+#else
+# define SKIP_WORD(m, k)  ((m) & ((size_t)-1 << ((k) * 8)))
+# define KEEP_WORD(m, k)  ((m) & ((size_t)-1 >> ((sizeof(size_t) - (k)) * 8)))
+# define LAST_WORD(m)     ((size_t)(63 - __builtin_clzll(m)) / 8)
+#endif
+
+RSCAN_KERNEL(rscan_portable, cpu_aword_t, size_t, SPLAT_WORD, MATCH_WORD, SKIP_WORD, KEEP_WORD, LAST_WORD)
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * Macros for vector kernels, see `RSCAN_KERNEL`.
+ * The masks have one bit per byte.
+ */
+#define SPLAT_VEC16(c)     CPU_SPLAT_BYTES16(c)
+#define SPLAT_VEC32(c)     CPU_SPLAT_BYTES32(c)
+#define MATCH_VEC16(v, x)  CPU_MOVEMASK16((v) == (x))
+#define MATCH_VEC32(v, x)  CPU_MOVEMASK32((v) == (x))
+#define SKIP_VEC(m, k)     ((m) & (~0U << (k)))
+#define KEEP_VEC(m, k)     ((m) & (~0U >> (32 - (k))))
+#define LAST_VEC(m)        (31 - __builtin_clz(m))
+
+__attribute__((__target__("sse2")))
+RSCAN_KERNEL(rscan_sse2, cpu_bytes16_t, unsigned, SPLAT_VEC16, MATCH_VEC16, SKIP_VEC, KEEP_VEC, LAST_VEC)
+
+__attribute__((__target__("avx2")))
+RSCAN_KERNEL(rscan_avx2, cpu_bytes32_t, unsigned, SPLAT_VEC32, MATCH_VEC32, SKIP_VEC, KEEP_VEC, LAST_VEC)
+
+#endif
+
+
+/**
+ * The reverse scan kernels, the most preferred first.
+ */
+static const struct
+{
+  int features;
+  const char* (*kernel)(const char*, int, size_t);
+} __slibc_rscan_kernels[] =
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    { CPU_AVX2, rscan_avx2 },
+    { CPU_SSE2, rscan_sse2 },
+#endif
+    { 0,        rscan_portable },
+  };
+
+CPU_DISPATCH(const char*, __slibc_rscan, (const char* s, int c, size_t size), (s, c, size))
+
+
+
 /**
  * Find the last occurrence of a byte in a memory segment.
  * 
@@ -39,10 +169,6 @@
  */
 void* (memrchr)(const void* segment, int c, size_t size)
 {
-  char* s = segment;
-  while (size--)
-    if (s[size] == c)
-      return s + size;
-  return NULL;
+  return __slibc_rscan_kernel(segment, c, size);
 }
 
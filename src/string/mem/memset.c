@@ -16,6 +16,172 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
+
+
+
+/**
+ * Fill less than 32 bytes.
+ * 
+ * @param  d        The memory segment.
+ * @param  pattern  The 32-bit pattern.
+ * @param  size     The size of the memory segment, less than 32.
+ */
+__GCC_ONLY(__attribute__((__always_inline__)))
+static inline void fill_small(char* d, uint32_t pattern, size_t size)
+{
+  uint64_t wide = pattern | ((uint64_t)pattern << 32);
+  
+  /* Two possibly overlapping stores cover every size
+   * from a power of two up to twice that size. */
+  if (size >= 16)
+    {
+      *(cpu_u64_t*)d = *(cpu_u64_t*)(d + 8) = wide;
+      *(cpu_u64_t*)(d + size - 16) = *(cpu_u64_t*)(d + size - 8) = wide;
+    }
+  else if (size >= 8)
+    *(cpu_u64_t*)d = *(cpu_u64_t*)(d + size - 8) = wide;
+  else if (size >= 4)
+    *(cpu_u32_t*)d = *(cpu_u32_t*)(d + size - 4) = pattern;
+  else if (size >= 2)
+    *(cpu_u16_t*)d = *(cpu_u16_t*)(d + size - 2) = (uint16_t)pattern;
+  else if (size)
+    *d = (char)pattern;
+}
+
+
+/**
+ * Define a fill kernel that uses units of the type `VEC`.
+ * 
+ * Less than two units are filled with overlapping stores.
+ * Otherwise, the first and last unit are stored at
+ * unaligned addresses, and the units in between at
+ * aligned addresses, four at a time.
+ * 
+ * @param  NAME       The name of the kernel.
+ * @param  VEC        The type of the units.
+ * @param  BROADCAST  Function-like macro that makes a unit
+ *                    with the pattern repeated in it.
+ * @param  STREAM     Function-like macro that stores a unit at
+ *                    an aligned address, with a non-temporal
+ *                    store if there is one.
+ * @param  FENCE      Statement that orders the non-temporal
+ *                    stores before later stores.
+ */
+#define FILL_KERNEL(NAME, VEC, BROADCAST, STREAM, FENCE)				\
+  static void* NAME(void* segment, uint32_t pattern, size_t size)			\
+  {											\
+    const size_t n = sizeof(VEC);							\
+    char* d = segment;									\
+    VEC v;										\
+    size_t i;										\
+											\
+    if (size < n)									\
+      return fill_small(d, pattern, size), segment;					\
+    v = BROADCAST(pattern);								\
+    *(VEC*)d = v;									\
+    *(VEC*)(d + size - n) = v;								\
+    if (size <= 2 * n)									\
+      return segment;									\
+											\
+    i = n - ((size_t)d & (n - 1));							\
+    if (size >= CPU_NONTEMPORAL_MIN)							\
+      {											\
+	for (; size - i > 4 * n; i += 4 * n)						\
+	  {										\
+	    STREAM(d + i + 0 * n, v);							\
+	    STREAM(d + i + 1 * n, v);							\
+	    STREAM(d + i + 2 * n, v);							\
+	    STREAM(d + i + 3 * n, v);							\
+	  }										\
+	FENCE;										\
+      }											\
+    for (; size - i > 4 * n; i += 4 * n)						\
+      {											\
+	*(VEC*)(d + i + 0 * n) = v;							\
+	*(VEC*)(d + i + 1 * n) = v;							\
+	*(VEC*)(d + i + 2 * n) = v;							\
+	*(VEC*)(d + i + 3 * n) = v;							\
+      }											\
+    for (; size - i > n; i += n)							\
+      *(VEC*)(d + i) = v;								\
+    return segment;									\
+  }
+
+
+/**
+ * Make a word with a 32-bit pattern repeated in it.
+ * 
+ * @param   p  The pattern.
+ * @return     The word.
+ */
+#define BROADCAST_WORD(p)  ((cpu_word_t)(p) | ((cpu_word_t)(p) << 16 << 16))
+
+/**
+ * Store a word, there are no portable non-temporal stores.
+ * 
+ * @param  p  The address.
+ * @param  v  The word.
+ */
+#define STORE_WORD(p, v)  (*(cpu_word_t*)(p) = (v))
+
+FILL_KERNEL(fill_portable, cpu_word_t, BROADCAST_WORD, STORE_WORD, (void)0)
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * Aligned vectors, for non-temporal stores and broadcasting.
+ */
+typedef long long int v2di_t __attribute__((__vector_size__(16)));
+typedef long long int v4di_t __attribute__((__vector_size__(32)));
+typedef uint32_t v4su_t __attribute__((__vector_size__(16)));
+typedef uint32_t v8su_t __attribute__((__vector_size__(32)));
+
+/**
+ * Make a vector with a 32-bit pattern repeated in it.
+ * 
+ * @param   p  The pattern.
+ * @return     The vector.
+ */
+#define BROADCAST_VEC16(p)  ((cpu_vec16_t)(v4su_t){ p, p, p, p })
+#define BROADCAST_VEC32(p)  ((cpu_vec32_t)(v8su_t){ p, p, p, p, p, p, p, p })
+
+/**
+ * Store a vector with a non-temporal store.
+ * 
+ * @param  p  The address, aligned to the size of the vector.
+ * @param  v  The vector.
+ */
+#define STREAM_VEC16(p, v)  __builtin_ia32_movntdq((v2di_t*)(void*)(p), (v))
+#define STREAM_VEC32(p, v)  __builtin_ia32_movntdq256((v4di_t*)(void*)(p), (v))
+
+__attribute__((__target__("sse2")))
+FILL_KERNEL(fill_sse2, cpu_vec16_t, BROADCAST_VEC16, STREAM_VEC16, __builtin_ia32_sfence())
+
+__attribute__((__target__("avx2")))
+FILL_KERNEL(fill_avx2, cpu_vec32_t, BROADCAST_VEC32, STREAM_VEC32, __builtin_ia32_sfence())
+
+#endif
+
+
+/**
+ * The fill kernels, the most preferred first.
+ */
+static const struct
+{
+  int features;
+  void* (*kernel)(void*, uint32_t, size_t);
+} __slibc_fill_kernels[] =
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    { CPU_AVX2, fill_avx2 },
+    { CPU_SSE2, fill_sse2 },
+#endif
+    { 0,        fill_portable },
+  };
+
+CPU_DISPATCH(void*, __slibc_fill, (void* segment, uint32_t pattern, size_t size), (segment, pattern, size))
 
 
 
@@ -31,9 +197,6 @@
  */
 void* memset(void* segment, int c, size_t size)
 {
-  char* s = segment;
-  while (size--)
-    *s++ = (char)c;
-  return segment;
+  return __slibc_fill_kernel(segment, (uint32_t)(unsigned char)c * UINT32_C(0x01010101), size);
 }
 
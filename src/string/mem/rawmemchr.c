@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
 
 
 # pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
@@ -36,9 +37,6 @@
  */
 void* (rawmemchr)(const void* segment, int c)
 {
-  char* s = segment;
-  for (;;)
-    if (*s++ == c)
-      return s - 1;
+  return __slibc_scan_kernel(segment, c, c, SIZE_MAX);
 }
 
@@ -18,6 +18,7 @@
 #include <string.h>
 #include <stdint.h>
 #include <ctype.h>
+#include "cpu.h"
 /* TEMPORARY {{ */
 #define STATIC static __attribute__((__used__))
 # pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
@@ -319,59 +320,39 @@ char* (strcnchrnul)(const char* string, int c, int stop, size_t maxlen) /* slibc
       return string;
 }
 
+/* The reverse searches find where the searched part ends
+ * with a forward scan, and then scan that part backwards,
+ * rather than remembering the last match during a forward
+ * byte-by-byte scan. The terminating NUL byte is a part of
+ * the searched part, but the `stop` byte is not. */
+
 char* (strnrchr)(const char* string, int c, size_t maxlen) /* slibc: completeness */
 {
-  char* r = NULL;
-  for (; maxlen--; string++)
-    if (*string == c)
-      r = string;
-    else if (!*string)
-      return c ? r : string;
-  return NULL;
+  size_t n = strnlen(string, maxlen);
+  return __slibc_rscan_kernel(string, c, n + (n < maxlen));
 }
 
 void* (memcrchr)(const void* segment, int c, int stop, size_t size) /* slibc: completeness */
 {
-  char* r = NULL;
-  char* s = segment;
-  for (;; size--)
-    if (*s == c)
-      r = s;
-    else if ((*s == stop) || !size)
-      return r;
+  const char* end = (char)stop == (char)c ? NULL : __slibc_scan_kernel(segment, stop, stop, size);
+  return __slibc_rscan_kernel(segment, c, end == NULL ? size : (size_t)(end - (const char*)segment));
 }
 
 char* (strcrchr)(const char* string, int c, int stop) /* slibc: completeness */
 {
-  char* r = NULL;
-  for (;; string++)
-    if (*string == c)
-      r = string;
-    else if (!*string)
-      return c ? r : string;
-    else if (*string == stop)
-      return r;
+  const char* end = __slibc_scan_kernel(string, (char)stop == (char)c ? 0 : stop, 0, SIZE_MAX);
+  return __slibc_rscan_kernel(string, c, (size_t)(end - string) + !*end);
 }
 
 char* (strcnrchr)(const char* string, int c, int stop, size_t maxlen) /* slibc: completeness */
 {
-  char* r = NULL;
-  for (; maxlen--; string++)
-    if (*string == c)
-      r = string;
-    else if (!*string)
-      return c ? r : string;
-    else if (*string == stop)
-      return r;
-  return NULL;
+  const char* end = __slibc_scan_kernel(string, (char)stop == (char)c ? 0 : stop, 0, maxlen);
+  return __slibc_rscan_kernel(string, c, end == NULL ? maxlen : (size_t)(end - string) + !*end);
 }
 
 void* (rawmemrchr)(const void* segment, int c, size_t size) /* slibc+gnu: completeness */
 {
-  char* s = segment;
-  for (;;)
-    if (s[--size] == c)
-      return s + size;
+  return __slibc_rscan_kernel(segment, c, size);
 }
 
 void* (rawmemcasemem)(const void* haystack, const void* needle, size_t needle_length) /* slibc */
@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
 
 
 # pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
@@ -39,10 +40,7 @@
  */
 char* (strchr)(const char* string, int c)
 {
-  for (;;)
-    if (*string == c)
-      return string;
-    else if (!*string++)
-      return NULL;
+  string = __slibc_scan_kernel(string, c, 0, SIZE_MAX);
+  return *string == (char)c ? string : NULL;
 }
 
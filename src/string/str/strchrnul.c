@@ -16,12 +16,139 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
 
 
 # pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
 
 
 
+/**
+ * Define a scan kernel that loads units of the type `VEC`.
+ * 
+ * The units are loaded from aligned addresses, so a load never
+ * crosses into another page, even if it reads past the end of
+ * the string or memory segment. Once four units are aligned
+ * together, they are loaded four at a time.
+ * 
+ * @param  NAME   The name of the kernel.
+ * @param  VEC    The type of the units.
+ * @param  MASK   The type of the masks of matching bytes.
+ * @param  SPLAT  Function-like macro that makes a unit with
+ *                a byte repeated in it.
+ * @param  MATCH  Function-like macro that makes the mask of the
+ *                bytes in the unit `v` that are equal to the
+ *                bytes in the unit `x` or the unit `y`.
+ * @param  SKIP   Function-like macro that removes the first
+ *                `k` bytes from the mask `m`.
+ * @param  FIRST  Function-like macro that gets the index of
+ *                the first byte in the non-zero mask `m`.
+ */
+#define SCAN_KERNEL(NAME, VEC, MASK, SPLAT, MATCH, SKIP, FIRST)				\
+  __GCC_ONLY(__attribute__((__pure__)))							\
+  static const char* NAME(const char* s, int c1, int c2, size_t size)			\
+  {											\
+    const size_t n = sizeof(VEC);							\
+    const char* a = s - ((size_t)s & (n - 1));						\
+    VEC x = SPLAT(c1), y = SPLAT(c2);							\
+    size_t i, scanned = n - (size_t)(s - a);						\
+    MASK m, m1, m2, m3;									\
+											\
+    if (!size)										\
+      return NULL;									\
+    m = SKIP(MATCH(*(const VEC*)a, x, y), (size_t)(s - a));				\
+    while (!m && ((size_t)(a + n) & (4 * n - 1)))					\
+      {											\
+	if (scanned >= size)								\
+	  return NULL;									\
+	a += n, scanned += n;								\
+	m = MATCH(*(const VEC*)a, x, y);						\
+      }											\
+    while (!m)										\
+      {											\
+	if (scanned >= size)								\
+	  return NULL;									\
+	a += n;										\
+	m  = MATCH(((const VEC*)a)[0], x, y);						\
+	m1 = MATCH(((const VEC*)a)[1], x, y);						\
+	m2 = MATCH(((const VEC*)a)[2], x, y);						\
+	m3 = MATCH(((const VEC*)a)[3], x, y);						\
+	if (m | m1 | m2 | m3)								\
+	  {										\
+	    if (!m)									\
+	      a += n, m = m1;								\
+	    if (!m)									\
+	      a += n, m = m2;								\
+	    if (!m)									\
+	      a += n, m = m3;								\
+	    break;									\
+	  }										\
+	a += 3 * n, scanned += 4 * n;							\
+      }											\
+											\
+    i = (size_t)(a - s) + (size_t)FIRST(m);						\
+    return i < size ? s + i : NULL;							\
+  }
+
+
+/**
+ * Macros for word kernels, see `SCAN_KERNEL`.
+ */
+#define SPLAT_WORD(c)        CPU_SPLAT_WORD(c)
+#define MATCH_WORD(v, x, y)  (CPU_ZEROS((v) ^ (x)) | CPU_ZEROS((v) ^ (y)))
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+# define SKIP_WORD(m, k)     ((m) & ((size_t)-1 >> ((k) * 8)))
+# define FIRST_WORD(m)       (__builtin_clzll(m) / 8 - (8 - sizeof(size_t)))
+#else
+# define SKIP_WORD(m, k)     ((m) & ((size_t)-1 << ((k) * 8)))
+# define FIRST_WORD(m)       (__builtin_ctzll(m) / 8)
+#endif
+
+SCAN_KERNEL(scan_portable, cpu_aword_t, size_t, SPLAT_WORD, MATCH_WORD, SKIP_WORD, FIRST_WORD)
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * Macros for vector kernels, see `SCAN_KERNEL`.
+ * The masks have one bit per byte.
+ */
+#define SPLAT_VEC16(c)        CPU_SPLAT_BYTES16(c)
+#define SPLAT_VEC32(c)        CPU_SPLAT_BYTES32(c)
+#define MATCH_VEC16(v, x, y)  CPU_MOVEMASK16(((v) == (x)) | ((v) == (y)))
+#define MATCH_VEC32(v, x, y)  CPU_MOVEMASK32(((v) == (x)) | ((v) == (y)))
+#define SKIP_VEC(m, k)        ((m) & (~0U << (k)))
+#define FIRST_VEC(m)          __builtin_ctz(m)
+
+__attribute__((__target__("sse2")))
+SCAN_KERNEL(scan_sse2, cpu_bytes16_t, unsigned, SPLAT_VEC16, MATCH_VEC16, SKIP_VEC, FIRST_VEC)
+
+__attribute__((__target__("avx2")))
+SCAN_KERNEL(scan_avx2, cpu_bytes32_t, unsigned, SPLAT_VEC32, MATCH_VEC32, SKIP_VEC, FIRST_VEC)
+
+#endif
+
+
+/**
+ * The scan kernels, the most preferred first.
+ */
+static const struct
+{
+  int features;
+  const char* (*kernel)(const char*, int, int, size_t);
+} __slibc_scan_kernels[] =
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    { CPU_AVX2, scan_avx2 },
+    { CPU_SSE2, scan_sse2 },
+#endif
+    { 0,        scan_portable },
+  };
+
+CPU_DISPATCH(const char*, __slibc_scan, (const char* s, int c1, int c2, size_t size), (s, c1, c2, size))
+
+
+
 /**
  * Find the first occurrence of a byte in a string, or
  * if there is no such byte, the end of the string.
@@ -40,10 +167,6 @@
  */
 char* (strchrnul)(const char* string, int c)
 {
-  for (;; string++)
-    if (*string == c)
-      return string;
-    else if (!*string)
-      return string;
+  return __slibc_scan_kernel(string, c, 0, SIZE_MAX);
 }
 
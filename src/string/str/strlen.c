@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
 
 
 
@@ -30,8 +31,6 @@
  */
 size_t strlen(const char* str)
 {
-  const char* s = str;
-  while (*str++);
-  return (size_t)(s - 1 - str);
+  return (size_t)(__slibc_scan_kernel(str, 0, 0, SIZE_MAX) - str);
 }
 
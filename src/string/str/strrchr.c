@@ -16,12 +16,155 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
 
 
 # pragma GCC diagnostic ignored "-Wdiscarded-qualifiers"
 
 
 
+/**
+ * Define a kernel that finds the last occurrence of a byte in
+ * a string, in one forward pass, by loading units of the type
+ * `VEC`, and remembering the last unit that had a match until
+ * the unit with the terminating NUL byte is found.
+ * 
+ * The units are loaded from aligned addresses, so a load never
+ * crosses into another page, even if it reads outside the string.
+ * 
+ * @param  NAME   The name of the kernel.
+ * @param  VEC    The type of the units.
+ * @param  MASK   The type of the masks of matching bytes.
+ * @param  SPLAT  Function-like macro that makes a unit with
+ *                a byte repeated in it.
+ * @param  MATCH  Function-like macro that makes the mask of the
+ *                bytes in the unit `v` that are equal to the
+ *                bytes in the unit `x`.
+ * @param  SKIP   Function-like macro that removes the first
+ *                `k` bytes from the mask `m`.
+ * @param  KEEP   Function-like macro that removes all but the
+ *                first `k` bytes, `k` is positive, from the
+ *                mask `m`.
+ * @param  FIRST  Function-like macro that gets the index of
+ *                the first byte in the non-zero mask `m`.
+ * @param  LAST   Function-like macro that gets the index of
+ *                the last byte in the non-zero mask `m`.
+ */
+#define RCHR_KERNEL(NAME, VEC, MASK, SPLAT, MATCH, SKIP, KEEP, FIRST, LAST)		\
+  __GCC_ONLY(__attribute__((__pure__)))							\
+  static const char* NAME(const char* s, int c)						\
+  {											\
+    const size_t n = sizeof(VEC);							\
+    const char* a = s - ((size_t)s & (n - 1));						\
+    const char* last = NULL;								\
+    VEC x = SPLAT(c), z = SPLAT(0);							\
+    MASK m, nul, last_m = 0, m1, m2, m3, nul1, nul2, nul3;				\
+											\
+    m   = SKIP(MATCH(*(const VEC*)a, x), (size_t)(s - a));				\
+    nul = SKIP(MATCH(*(const VEC*)a, z), (size_t)(s - a));				\
+    while (!nul)									\
+      {											\
+	if (m)										\
+	  last = a, last_m = m;								\
+	a += n;										\
+	m   = MATCH(((const VEC*)a)[0], x);						\
+	nul = MATCH(((const VEC*)a)[0], z);						\
+	if (nul || ((size_t)a & (4 * n - 1)))						\
+	  continue;									\
+											\
+	/* Four units, that are aligned together, are					\
+	 * checked at a time until the end is near. */					\
+	nul1 = MATCH(((const VEC*)a)[1], z);						\
+	nul2 = MATCH(((const VEC*)a)[2], z);						\
+	nul3 = MATCH(((const VEC*)a)[3], z);						\
+	if (nul1 | nul2 | nul3)								\
+	  continue;									\
+	m1 = MATCH(((const VEC*)a)[1], x);						\
+	m2 = MATCH(((const VEC*)a)[2], x);						\
+	m3 = MATCH(((const VEC*)a)[3], x);						\
+	if (m3)										\
+	  last = a + 3 * n, last_m = m3;						\
+	else if (m2)									\
+	  last = a + 2 * n, last_m = m2;						\
+	else if (m1)									\
+	  last = a + n, last_m = m1;							\
+	else if (m)									\
+	  last = a, last_m = m;								\
+	a += 3 * n, m = 0;								\
+      }											\
+											\
+    /* The terminating NUL byte is a part of the string. */				\
+    m = KEEP(m, (size_t)FIRST(nul) + 1);						\
+    if (m)										\
+      return a + LAST(m);								\
+    return last ? last + LAST(last_m) : NULL;						\
+  }
+
+
+/**
+ * Macros for word kernels, see `RCHR_KERNEL`.
+ */
+#define SPLAT_WORD(c)     CPU_SPLAT_WORD(c)
+#define MATCH_WORD(v, x)  CPU_ZEROS((v) ^ (x))
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+# define SKIP_WORD(m, k)  ((m) & ((size_t)-1 >> ((k) * 8)))
+# define KEEP_WORD(m, k)  ((m) & ((size_t)-1 << ((sizeof(size_t) - (k)) * 8)))
+# define FIRST_WORD(m)    (__builtin_clzll(m) / 8 - (8 - sizeof(size_t)))
+# define LAST_WORD(m)     (sizeof(size_t) - 1 - (size_t)__builtin_ctzll(m) / 8)
+#else
+# define SKIP_WORD(m, k)  ((m) & ((size_t)-1 << ((k) * 8)))
+# define KEEP_WORD(m, k)  ((m) & ((size_t)-1 >> ((sizeof(size_t) - (k)) * 8)))
+# define FIRST_WORD(m)    (__builtin_ctzll(m) / 8)
+# define LAST_WORD(m)     ((size_t)(63 - __builtin_clzll(m)) / 8)
+#endif
+
+RCHR_KERNEL(rchr_portable, cpu_aword_t, size_t, SPLAT_WORD, MATCH_WORD, SKIP_WORD, KEEP_WORD, FIRST_WORD, LAST_WORD)
+
+
+#if defined(__x86_64__) || defined(__i386__)
+
+/**
+ * Macros for vector kernels, see `RCHR_KERNEL`.
+ * The masks have one bit per byte.
+ */
+#define SPLAT_VEC16(c)     CPU_SPLAT_BYTES16(c)
+#define SPLAT_VEC32(c)     CPU_SPLAT_BYTES32(c)
+#define MATCH_VEC16(v, x)  CPU_MOVEMASK16((v) == (x))
+#define MATCH_VEC32(v, x)  CPU_MOVEMASK32((v) == (x))
+#define SKIP_VEC(m, k)     ((m) & (~0U << (k)))
+#define KEEP_VEC(m, k)     ((m) & (~0U >> (32 - (k))))
+#define FIRST_VEC(m)       __builtin_ctz(m)
+#define LAST_VEC(m)        (31 - __builtin_clz(m))
+
+__attribute__((__target__("sse2")))
+RCHR_KERNEL(rchr_sse2, cpu_bytes16_t, unsigned, SPLAT_VEC16, MATCH_VEC16, SKIP_VEC, KEEP_VEC, FIRST_VEC, LAST_VEC)
+
+__attribute__((__target__("avx2")))
+RCHR_KERNEL(rchr_avx2, cpu_bytes32_t, unsigned, SPLAT_VEC32, MATCH_VEC32, SKIP_VEC, KEEP_VEC, FIRST_VEC, LAST_VEC)
+
+#endif
+
+
+/**
+ * The `strrchr` kernels, the most preferred first.
+ */
+static const struct
+{
+  int features;
+  const char* (*kernel)(const char*, int);
+} __slibc_strrchr_kernels[] =
+  {
+#if defined(__x86_64__) || defined(__i386__)
+    { CPU_AVX2, rchr_avx2 },
+    { CPU_SSE2, rchr_sse2 },
+#endif
+    { 0,        rchr_portable },
+  };
+
+CPU_DISPATCH(const char*, __slibc_strrchr, (const char* s, int c), (s, c))
+
+
+
 /**
  * Find the last occurrence of a byte in a string.
  * 
@@ -40,11 +183,6 @@
  */
 char* (strrchr)(const char* string, int c)
 {
-  char* r = NULL;
-  for (;;)
-    if (*string == c)
-      r = string;
-    else if (!*string++)
-      return c ? r : (string - 1);
+  return __slibc_strrchr_kernel(string, c);
 }
 
@@ -33,9 +33,6 @@
  */
 char* strset(char* str, int c)
 {
-  char* s = str;
-  while (*s)
-    *s++ = (char)c;
-  return str;
+  return memset(str, c, (size_t)((char*)rawmemchr(str, 0) - str));
 }
 
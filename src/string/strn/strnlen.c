@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <string.h>
+#include "../cpu.h"
 
 
 
@@ -32,7 +33,7 @@
  */
 size_t strnlen(const char* str, size_t maxlen)
 {
-  const char* end = memchr(str, 0, maxlen);
+  const char* end = __slibc_scan_kernel(str, 0, 0, maxlen);
   return end == NULL ? maxlen : (size_t)(end - str);
 }
 
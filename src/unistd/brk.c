@@ -0,0 +1,138 @@
+/**
+ * slibc — Yet another C library
+ * Copyright © 2015, 2016  Mattias Andrée (maandree@member.fsf.org)
+ * 
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ * 
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ * 
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <unistd.h>
+#include <errno.h>
+/* TODO #include <sys/syscall.h> */
+/* TODO temporary constants/functions from other headers { */
+#define SYS_brk  12
+long syscall(long, ...);
+/* } */
+
+
+
+/**
+ * The current high end of the data segment,
+ * `NULL` if it has not been retrieved yet.
+ */
+static char* current_brk = NULL;
+
+
+
+/**
+ * Set the high end of the calling process's
+ * data segment.
+ * 
+ * The high end is defined as the last byte
+ * in the segment plus 1.
+ * 
+ * Using `brk` is highly discouraged. `malloc`,
+ * `calloc` and `free`, and its related functions,
+ * fall be used instead as they are much more
+ * conformable. Use of `brk` can couse errors
+ * when using `malloc`, `free`, &c. Thus, `brk`
+ * shall (bascially) only be used if you are
+ * writting an alterantive malloc-implementation.
+ * 
+ * `brk` was marked LEGACY in SUSv2, and it
+ * was removed from the POSIX standard in revision
+ * POSIX.1-2001. It is however fundamental in
+ * implementing a fast `malloc`-implementation.
+ * 
+ * @etymology  Set (br)ea(k).
+ * 
+ * @param   address  The process's new high end of its data segment.
+ *                   If lower than the current low end, nothing will
+ *                   happen and the function will return with a success
+ *                   status.
+ * @return           Zero on succes, -1 on error. On error, `errno`
+ *                   is set to indicate the error.
+ * 
+ * @throws  ENOMEM  The process can allocate the requested amount
+ *                  of memory. Either the process store limit would
+ *                  have been exceeded, RAM and swap memory would
+ *                  have been exhausted, or the request would cause
+ *                  the data segment to overlap another segment.
+ * 
+ * @since  Always.
+ */
+int brk(void* address)
+{
+  /* The kernel returns the new high end, which is
+   * the old high end if the request was refused.
+   * Shrinking is only refused if `address` is below
+   * the low end of the data segment. */
+  current_brk = (char*)(size_t)syscall(SYS_brk, address);
+  if (current_brk < (char*)address)
+    return errno = ENOMEM, -1;
+  return 0;
+}
+
+
+/**
+ * Set and get the current high end of the calling
+ * process's data segment.
+ * 
+ * There is some documents that state that the new,
+ * rather than the previous, high end is returned.
+ * Additionally, some documentions do not document
+ * possible failure. Thus only `sbrk(0)` is guaranteed
+ * to be portable. The return type differs between
+ * implementations; common return types are `int`,
+ * `ssize_t`, `ptrdiff_t`, `ptrdiff_t`, `intptr_t`,
+ * and `void*`. Note that `int` is
+ * microarchitecture-portable.
+ * 
+ * `sbrk` was marked LEGACY in SUSv2, and it
+ * was removed from the POSIX standard in revision
+ * POSIX.1-2001. It is however fundamental in
+ * implementing a fast `malloc`-implementation.
+ * 
+ * @etymology  Shift (br)ea(k).
+ * 
+ * @param   delta  The incremant of the size of the data segment,
+ *                 zero means that the high end shall not be moved
+ *                 (thus the current high end is returned,) a
+ *                 positive value will cause the segment to grow,
+ *                 a negative value will cause the segment to shrink.
+ * @return         The previous high end. `(void*)-1` is returned on error.
+ * 
+ * @throws  ENOMEM  The process can allocate the requested amount
+ *                  of memory. Either the process store limit would
+ *                  have been exceeded, RAM and swap memory would
+ *                  have been exhausted, or the request would cause
+ *                  the data segment to overlap another segment.
+ * 
+ * @since  Always.
+ */
+void* sbrk(ptrdiff_t delta)
+{
+  char* old_brk;
+  
+  if (current_brk == NULL)
+    current_brk = (char*)(size_t)syscall(SYS_brk, NULL);
+  old_brk = current_brk;
+  if (delta == 0)
+    return old_brk;
+  
+  if ((delta > 0) ? ((size_t)delta > (size_t)-(size_t)old_brk) : (-(size_t)delta > (size_t)old_brk))
+    return errno = ENOMEM, (void*)-1;
+  if (brk(old_brk + delta))
+    return (void*)-1;
+  return old_brk;
+}
+
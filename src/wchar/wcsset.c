@@ -33,9 +33,6 @@
  */
 wchar_t* wcsset(wchar_t* str, wchar_t c)
 {
-  wchar_t* r = str;
-  while (*str)
-    *str++ = c;
-  return r;
+  return wmemset(str, c, wcslen(str));
 }
 
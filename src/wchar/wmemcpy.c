@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <wchar.h>
+#include "../string/cpu.h"
 
 
 
@@ -31,9 +32,6 @@
  */
 wchar_t* wmemcpy(wchar_t* restrict whither, const wchar_t* restrict whence, size_t size)
 {
-  wchar_t* r = whither;
-  while (size--)
-    *whither++ = *whence++;
-  return r;
+  return __slibc_memmove_kernel(whither, whence, size * sizeof(wchar_t));
 }
 
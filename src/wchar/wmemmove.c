@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <wchar.h>
+#include "../string/cpu.h"
 
 
 
@@ -33,13 +34,6 @@
  */
 wchar_t* wmemmove(wchar_t* whither, const wchar_t* whence, size_t size)
 {
-  wchar_t* r = whither;
-  if ((size_t)(whither - whence) < size)
-    while (size--)
-      whither[size] = whence[size];
-  else
-    while (size--)
-      *whither++ = *whence++;
-  return r;
+  return __slibc_memmove_kernel(whither, whence, size * sizeof(wchar_t));
 }
 
@@ -16,6 +16,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include <wchar.h>
+#include "../string/cpu.h"
 
 
 
@@ -32,6 +33,11 @@
 wchar_t* wmemset(wchar_t* segment, wchar_t c, size_t size)
 {
   wchar_t* r = segment;
+  /* The fill kernels repeat a 32-bit pattern. */
+  if (sizeof(wchar_t) == 4)
+    return __slibc_fill_kernel(segment, (uint32_t)c, size * sizeof(wchar_t));
+  if (sizeof(wchar_t) == 1)
+    return __slibc_fill_kernel(segment, (uint32_t)(unsigned char)c * UINT32_C(0x01010101), size);
   while (size--)
     *segment++ = c;
   return r;